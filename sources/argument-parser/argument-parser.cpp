@@ -2,7 +2,7 @@
 
 std::unordered_map<ArgumentType, std::string> ParseArguments(const int argc, char* argv[])
 {
-	if (argc < 2 || argc > 3)return std::unordered_map<ArgumentType, std::string>();
+	if (argc < 2)return std::unordered_map<ArgumentType, std::string>();
 
 	std::unordered_map<ArgumentType, std::string> returnValue;
 
@@ -10,16 +10,116 @@ std::unordered_map<ArgumentType, std::string> ParseArguments(const int argc, cha
 	{
 		std::string str(argv[i]);
 	
-		auto pos = str.find("-t");
-		if (pos != str.npos)
+		if (str.starts_with("--max-memory"))
 		{
-			pos = str.find_first_of("0123456789");
+			auto pos = str.find_first_of("0123456789");
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::MAX_MEMORY] = str.substr(pos);
+			}
+		}
+		else if (str.starts_with("--compare"))
+		{
+			auto pos = str.find('=');
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::COMPARE] = str.substr(pos + 1);
+			}
+		}
+		else if (str.starts_with("--sketch"))
+		{
+			auto pos = str.find_first_of("0123456789");
+
+			// Bare --sketch uses default sketch size
+			returnValue[ArgumentType::SKETCH] = pos != str.npos ? str.substr(pos) : "0";
+		}
+		else if (str.starts_with("--progress"))
+		{
+			auto pos = str.find_first_of("0123456789");
+
+			// Bare --progress reports every second
+			returnValue[ArgumentType::PROGRESS] = pos != str.npos ? str.substr(pos) : "1";
+		}
+		else if (str.starts_with("-t"))
+		{
+			auto pos = str.find_first_of("0123456789");
 
 			if (pos != str.npos) {
 				returnValue[ArgumentType::THREADS] = str.substr(pos);
 			}
 		}
-		else if((pos = str.find("-x")) != str.npos)
+		else if (str.starts_with("-c"))
+		{
+			auto pos = str.find_first_of("0123456789");
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::CHUNK_SIZE] = str.substr(pos);
+			}
+		}
+		else if (str.starts_with("-f"))
+		{
+			auto pos = str.find_first_of("0123456789");
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::FILTER_SIZE] = str.substr(pos);
+			}
+		}
+		else if (str.starts_with("-s"))
+		{
+			auto pos = str.find('=');
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::SEPARATORS] = str.substr(pos + 1);
+			}
+		}
+		else if (str.starts_with("-k"))
+		{
+			auto pos = str.find_first_of("0123456789");
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::FIELD] = str.substr(pos);
+			}
+		}
+		else if (str.starts_with("-n"))
+		{
+			auto pos = str.find_first_of("0123456789");
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::NGRAM] = str.substr(pos);
+			}
+		}
+		else if (str.starts_with("-o"))
+		{
+			auto pos = str.find('=');
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::OUTPUT] = str.substr(pos + 1);
+			}
+		}
+		else if (str.starts_with("-e"))
+		{
+			auto pos = str.find('=');
+
+			// Bare -e or -e= exports to standard output
+			returnValue[ArgumentType::EXPORT] = pos != str.npos && pos + 1 < str.size() ? str.substr(pos + 1) : "-";
+		}
+		else if (str.starts_with("-p"))
+		{
+			auto pos = str.find('=');
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::PARTITION] = str.substr(pos + 1);
+			}
+		}
+		else if (str.starts_with("-r"))
+		{
+			auto pos = str.find('=');
+
+			if (pos != str.npos) {
+				returnValue[ArgumentType::RANGE] = str.substr(pos + 1);
+			}
+		}
+		else if(str.starts_with("-x"))
 		{
 			returnValue[ArgumentType::TEST] = "true";
 		}
@@ -38,7 +138,7 @@ std::optional<std::size_t> ConvertArgument(const std::string& str)
 	std::size_t argument = 0;
 
 	try {
-		argument = std::stoi(str);
+		argument = std::stoull(str);
 	}
 	catch (const std::invalid_argument& ex)
 	{
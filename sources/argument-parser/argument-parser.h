@@ -8,7 +8,7 @@
 
 enum class ArgumentType
 {
-	FILE_NAME, THREADS, TEST
+	FILE_NAME, THREADS, TEST, CHUNK_SIZE, FILTER_SIZE, SEPARATORS, FIELD, OUTPUT, PARTITION, RANGE, MAX_MEMORY, NGRAM, EXPORT, COMPARE, SKETCH, PROGRESS
 };
 
 std::unordered_map<ArgumentType, std::string> ParseArguments(const int argc, char* argv[]);
@@ -1,102 +1,490 @@
 #ifndef  CONCURENT_SET_H
 #define CONCURENT_SET_H
 
-#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <mutex>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <type_traits>
+#include <atomic>
 
+#include "../hash/hash.h"
+#include "../tokenizer/tokenizer.h"
+#include "../delta-encoding/delta-encoding.h"
+
+/*
+	std::allocator which adds size of every allocation to external counter,
+	used to report exact memory usage of std containers
+*/
 template<class T>
+class CountingAllocator
+{
+public:
+	using value_type = T;
+
+	explicit CountingAllocator(std::size_t* bytes) noexcept : m_bytes(bytes) {}
+
+	template<class U>
+	CountingAllocator(const CountingAllocator<U>& other) noexcept : m_bytes(other.m_bytes) {}
+
+	T* allocate(const std::size_t n)
+	{
+		T* ptr = std::allocator<T>{}.allocate(n);
+		*m_bytes += n * sizeof(T);
+		return ptr;
+	}
+
+	void deallocate(T* ptr, const std::size_t n) noexcept
+	{
+		*m_bytes -= n * sizeof(T);
+		std::allocator<T>{}.deallocate(ptr, n);
+	}
+
+	template<class U>
+	bool operator==(const CountingAllocator<U>& other) const noexcept
+	{
+		return m_bytes == other.m_bytes;
+	}
+
+	std::size_t* m_bytes;
+};
+
+template<class T, class HashPolicy = WyHashPolicy>
 class ConcurentSet
 {
 public:
 	ConcurentSet(std::size_t buckets);
-	void Insert(const T& obj);
+
+	/*
+		Heterogeneous insert - accepts any type viewable as std::string_view
+		(T, std::string_view, const char*) without constructing T
+	*/
+	template<class Key = T>
+	void Insert(const Key& obj);
+
+	/*
+		Reuses hash calculated by Tokenizer when HashPolicy matches
+	*/
+	void Insert(const Token& token);
+
+	/*
+		Inserts precomputed HashPolicy::Hash value,
+		e.g. calculated by StreamingHasher while tokenizing.
+		word is kept only when SetKeepWords(true) was called.
+	*/
+	void InsertHash(const std::uint64_t hash, std::string_view word = {});
+
 	std::size_t GetSize() const;
+
+	/*
+		Lock-free upper bound of GetSize which can be read while inserting,
+		counts hash inserted again after its bucket was compacted twice
+	*/
+	std::size_t GetSizeEstimate() const;
+
+	/*
+		Calls function(std::uint64_t) once for every stored hash, bucket by bucket.
+		Must not run concurrently with inserts.
+	*/
+	template<class Function>
+	void ForEachHash(Function&& function) const;
+
+	/*
+		Bucket which holds threshold hashes in its hash set compacts them
+		into a sorted, delta-encoded run (see TieredHashRuns) and keeps
+		the hash set only as a write buffer.
+		0 disables compaction.
+	*/
+	void SetCompactionThreshold(const std::size_t& threshold);
+
+	/*
+		Chooses compaction threshold so write buffers use at most half of bytes.
+		Soft target: compacted runs (about 6 bytes per distinct hash) are not limited
+		and may exceed it on their own. Kept words (SetKeepWords) are not limited either,
+		word inserted again after its bucket was compacted is kept again until export.
+	*/
+	void SetMemoryBudget(const std::size_t& bytes);
+
+	/*
+		Bytes allocated by the set, its buckets, hash sets, compacted runs and kept words
+	*/
+	std::size_t GetMemoryUsage() const;
+
+	/*
+		Lock-free GetMemoryUsage which can be read while inserting,
+		buckets publish their bytes after every newly inserted hash
+	*/
+	std::size_t GetMemoryUsageEstimate() const;
+
+	/*
+		Part of GetMemoryUsage taken by kept words
+	*/
+	std::size_t GetWordsMemoryUsage() const;
+
+	/*
+		Keeps copy of every newly inserted word so it can be exported,
+		has to be set before the first insert
+	*/
+	void SetKeepWords(const bool keep);
+
+	std::size_t GetNumberOfBuckets() const;
+
+	/*
+		Calls function(std::uint64_t hash, std::string_view word) for every word kept by bucket.
+		Word inserted again after its bucket was compacted is kept twice, dedup on the hash.
+		Must not run concurrently with inserts.
+	*/
+	template<class Function>
+	void ForEachWord(const std::size_t& bucket, Function&& function) const;
 private:
 
 	class Bucket
 	{
 	public:
-		Bucket() = default;
+		Bucket();
 
-		void Insert(const std::size_t& obj);
-		void Insert(std::size_t&& obj);
+		void Insert(const std::uint64_t obj, const std::size_t compactionThreshold, std::string_view word);
 
 		std::size_t GetSize() const;
+		std::size_t GetSizeEstimate() const;
+
+		template<class Function>
+		void ForEachHash(Function&& function) const;
+
+		std::size_t GetMemoryUsage() const;
+		std::size_t GetMemoryUsageEstimate() const;
+		std::size_t GetWordsMemoryUsage() const;
+
+		template<class Function>
+		void ForEachWord(Function&& function) const;
 
 	private:
-		mutable std::mutex m_mutex;
-		std::unordered_set<std::size_t> m_hashes;
-	};
+		void Compact();
 
-	/*
-	Returns a pair which first element is bucket hash and second is hash itself
-	*/
-	std::pair<std::size_t, std::size_t> CalculateHash(const T& obj) const;
+		/*
+			Calls function for hashes in write buffer which are not in compacted run
+		*/
+		template<class Function>
+		void ForEachPending(Function&& function) const;
 
+		mutable std::mutex m_mutex;
+		std::size_t m_allocatedBytes;
+		std::unordered_set<std::uint64_t, SlotHasher<HashPolicy>, std::equal_to<std::uint64_t>, CountingAllocator<std::uint64_t>> m_hashes;
+		TieredHashRuns m_compacted;
+		// m_compacted.GetMemoryUsage, changes only in Compact
+		std::size_t m_compactedBytes;
+		// Kept words, every one prefixed with its 8 byte hash and 4 byte length
+		std::string m_words;
+		// Compacted plus buffered hashes, published for GetSizeEstimate
+		std::atomic<std::size_t> m_sizeEstimate;
+		// Bytes of GetMemoryUsage, published for GetMemoryUsageEstimate
+		std::atomic<std::size_t> m_memoryEstimate;
+	};
 
 	std::size_t m_buckets;
-	std::unordered_map <std::size_t, Bucket> m_bucketTable;
+	std::size_t m_compactionThreshold;
+	bool m_keepWords;
+	std::vector<Bucket> m_bucketTable;
 };
 
-template<class T>
-inline ConcurentSet<T>::ConcurentSet(std::size_t buckets)
+template<class T, class HashPolicy>
+inline ConcurentSet<T, HashPolicy>::ConcurentSet(std::size_t buckets)
 {
 	if (buckets == 0)buckets = 1;
 
 	m_buckets = buckets;
-	for (std::size_t bucketID = 0; bucketID < m_buckets; ++bucketID)
+	m_compactionThreshold = 0;
+	m_keepWords = false;
+	m_bucketTable = std::vector<Bucket>(m_buckets);
+}
+
+template<class T, class HashPolicy>
+template<class Key>
+inline void ConcurentSet<T, HashPolicy>::Insert(const Key& obj)
+{
+	const std::string_view word(obj);
+	InsertHash(HashPolicy::Hash(word), word);
+}
+
+template<class T, class HashPolicy>
+inline void ConcurentSet<T, HashPolicy>::Insert(const Token& token)
+{
+	if constexpr (std::is_same_v<HashPolicy, WyHashPolicy>)
 	{
-		m_bucketTable.try_emplace(bucketID);
+		InsertHash(token.m_hash, token.m_word);
+	}
+	else
+	{
+		InsertHash(HashPolicy::Hash(token.m_word), token.m_word);
 	}
 }
 
-template<class T>
-inline void ConcurentSet<T>::Insert(const T& obj)
+template<class T, class HashPolicy>
+inline void ConcurentSet<T, HashPolicy>::InsertHash(const std::uint64_t hash, std::string_view word)
 {
-	const auto hashPair = CalculateHash(obj);
-	m_bucketTable[hashPair.first].Insert(hashPair.second);
+	m_bucketTable[HashPolicy::Bucket(hash, m_buckets)].Insert(hash, m_compactionThreshold, m_keepWords ? word : std::string_view());
 }
 
-template<class T>
-inline std::size_t ConcurentSet<T>::GetSize() const
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::GetSize() const
 {
 	std::size_t size = 0;
 	for (const auto & bucket : m_bucketTable)
 	{
-		size += bucket.second.GetSize();
+		size += bucket.GetSize();
 	}
 
 	return size;
 }
 
-template<class T>
-inline std::pair<std::size_t, std::size_t> ConcurentSet<T>::CalculateHash(const T & obj) const
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::GetSizeEstimate() const
 {
-	const std::size_t hash = std::hash<T>{}(obj);
-	const std::size_t bucketHash = hash % m_buckets;
+	std::size_t size = 0;
+	for (const auto& bucket : m_bucketTable)
+	{
+		size += bucket.GetSizeEstimate();
+	}
 
-	return std::make_pair(std::move(bucketHash), std::move(hash));
+	return size;
 }
 
-template<class T>
-inline void ConcurentSet<T>::Bucket::Insert(const std::size_t& obj)
+template<class T, class HashPolicy>
+template<class Function>
+inline void ConcurentSet<T, HashPolicy>::ForEachHash(Function&& function) const
+{
+	for (const auto& bucket : m_bucketTable)
+	{
+		bucket.ForEachHash(function);
+	}
+}
+
+template<class T, class HashPolicy>
+inline void ConcurentSet<T, HashPolicy>::SetCompactionThreshold(const std::size_t& threshold)
+{
+	m_compactionThreshold = threshold;
+}
+
+template<class T, class HashPolicy>
+inline void ConcurentSet<T, HashPolicy>::SetMemoryBudget(const std::size_t& bytes)
+{
+	// Hash set node with cached hash code plus its share of the bucket array
+	constexpr std::size_t bytesPerBufferedHash = 40;
+	constexpr std::size_t minimalThreshold = 1024;
+
+	if (bytes == 0)
+	{
+		SetCompactionThreshold(0);
+		return;
+	}
+
+	SetCompactionThreshold(std::max(bytes / 2 / (m_buckets * bytesPerBufferedHash), minimalThreshold));
+}
+
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::GetMemoryUsage() const
+{
+	std::size_t bytes = sizeof(*this) + m_bucketTable.capacity() * sizeof(Bucket);
+	for (const auto& bucket : m_bucketTable)
+	{
+		bytes += bucket.GetMemoryUsage();
+	}
+
+	return bytes;
+}
+
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::GetMemoryUsageEstimate() const
+{
+	std::size_t bytes = sizeof(*this) + m_bucketTable.capacity() * sizeof(Bucket);
+	for (const auto& bucket : m_bucketTable)
+	{
+		bytes += bucket.GetMemoryUsageEstimate();
+	}
+
+	return bytes;
+}
+
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::GetWordsMemoryUsage() const
+{
+	std::size_t bytes = 0;
+	for (const auto& bucket : m_bucketTable)
+	{
+		bytes += bucket.GetWordsMemoryUsage();
+	}
+
+	return bytes;
+}
+
+template<class T, class HashPolicy>
+inline void ConcurentSet<T, HashPolicy>::SetKeepWords(const bool keep)
+{
+	m_keepWords = keep;
+}
+
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::GetNumberOfBuckets() const
+{
+	return m_buckets;
+}
+
+template<class T, class HashPolicy>
+template<class Function>
+inline void ConcurentSet<T, HashPolicy>::ForEachWord(const std::size_t& bucket, Function&& function) const
+{
+	m_bucketTable[bucket].ForEachWord(function);
+}
+
+/*
+* Bucket
+*/
+template<class T, class HashPolicy>
+inline ConcurentSet<T, HashPolicy>::Bucket::Bucket()
+	: m_allocatedBytes(0),
+	m_hashes(0, SlotHasher<HashPolicy>(), std::equal_to<std::uint64_t>(), CountingAllocator<std::uint64_t>(&m_allocatedBytes)),
+	m_compactedBytes(m_compacted.GetMemoryUsage()),
+	m_sizeEstimate(0),
+	m_memoryEstimate(0)
+{
+}
+
+template<class T, class HashPolicy>
+inline void ConcurentSet<T, HashPolicy>::Bucket::Insert(const std::uint64_t obj, const std::size_t compactionThreshold, std::string_view word)
 {
 	std::lock_guard lock(m_mutex);
-	m_hashes.insert(obj);
+	const bool inserted = m_hashes.insert(obj).second;
+
+	if (inserted && !word.empty())
+	{
+		const std::uint32_t length = (std::uint32_t)word.size();
+		m_words.append((const char*)&obj, sizeof(obj));
+		m_words.append((const char*)&length, sizeof(length));
+		m_words.append(word);
+	}
+
+	if (compactionThreshold != 0 && m_hashes.size() >= compactionThreshold)
+	{
+		Compact();
+	}
+
+	if (inserted)
+	{
+		m_sizeEstimate.store(m_compacted.GetStoredHashes() + m_hashes.size(), std::memory_order_relaxed);
+		m_memoryEstimate.store(m_allocatedBytes + m_compactedBytes + m_words.capacity(), std::memory_order_relaxed);
+	}
 }
 
-template<class T>
-inline void ConcurentSet<T>::Bucket::Insert(std::size_t&& obj)
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::Bucket::GetSize() const
 {
 	std::lock_guard lock(m_mutex);
-	m_hashes.insert(std::move(obj));
+	if (m_compacted.Empty())return m_hashes.size();
+
+	// Runs may share hashes, count them by walking
+	std::size_t size = 0;
+	m_compacted.ForEach([&size](const std::uint64_t) {
+		size++;
+	});
+	ForEachPending([&size](const std::uint64_t) {
+		size++;
+	});
+
+	return size;
 }
 
-template<class T>
-inline std::size_t ConcurentSet<T>::Bucket::GetSize() const
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::Bucket::GetSizeEstimate() const
+{
+	return m_sizeEstimate.load(std::memory_order_relaxed);
+}
+
+template<class T, class HashPolicy>
+template<class Function>
+inline void ConcurentSet<T, HashPolicy>::Bucket::ForEachHash(Function&& function) const
+{
+	std::lock_guard lock(m_mutex);
+	m_compacted.ForEach(function);
+	ForEachPending(function);
+}
+
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::Bucket::GetMemoryUsage() const
 {
 	std::lock_guard lock(m_mutex);
-	return m_hashes.size();
+	return m_allocatedBytes + m_compactedBytes + m_words.capacity();
+}
+
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::Bucket::GetWordsMemoryUsage() const
+{
+	std::lock_guard lock(m_mutex);
+	return m_words.capacity();
+}
+
+template<class T, class HashPolicy>
+inline std::size_t ConcurentSet<T, HashPolicy>::Bucket::GetMemoryUsageEstimate() const
+{
+	return m_memoryEstimate.load(std::memory_order_relaxed);
+}
+
+template<class T, class HashPolicy>
+template<class Function>
+inline void ConcurentSet<T, HashPolicy>::Bucket::ForEachWord(Function&& function) const
+{
+	std::lock_guard lock(m_mutex);
+	std::size_t position = 0;
+	while (position < m_words.size())
+	{
+		std::uint64_t hash = 0;
+		std::memcpy(&hash, m_words.data() + position, sizeof(hash));
+		position += sizeof(hash);
+		std::uint32_t length = 0;
+		std::memcpy(&length, m_words.data() + position, sizeof(length));
+		position += sizeof(length);
+
+		function(hash, std::string_view(m_words.data() + position, length));
+		position += length;
+	}
+}
+
+template<class T, class HashPolicy>
+inline void ConcurentSet<T, HashPolicy>::Bucket::Compact()
+{
+	std::vector<std::uint64_t> sorted(m_hashes.begin(), m_hashes.end());
+	std::sort(sorted.begin(), sorted.end());
+
+	m_compacted.Add(sorted);
+	m_compactedBytes = m_compacted.GetMemoryUsage();
+
+	// Bucket array is kept, the next batch fills it up to the same size
+	m_hashes.clear();
+}
+
+template<class T, class HashPolicy>
+template<class Function>
+inline void ConcurentSet<T, HashPolicy>::Bucket::ForEachPending(Function&& function) const
+{
+	if (m_compacted.Empty())
+	{
+		for (const std::uint64_t hash : m_hashes)function(hash);
+		return;
+	}
+
+	std::vector<std::uint64_t> sorted(m_hashes.begin(), m_hashes.end());
+	std::sort(sorted.begin(), sorted.end());
+
+	// Both sequences are sorted, walk them together
+	auto pending = sorted.begin();
+	m_compacted.ForEach([&](const std::uint64_t compacted) {
+		while (pending != sorted.end() && *pending < compacted)function(*pending++);
+		if (pending != sorted.end() && *pending == compacted)pending++;
+	});
+	while (pending != sorted.end())function(*pending++);
 }
 #endif // ! CONCURENT_SET_H
\ No newline at end of file
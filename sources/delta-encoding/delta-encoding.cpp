@@ -0,0 +1,129 @@
+#include "delta-encoding.h"
+
+DeltaEncodedHashes::DeltaEncodedHashes()
+{
+	m_count = 0;
+}
+
+std::size_t DeltaEncodedHashes::Merge(const std::vector<std::uint64_t>& sortedHashes)
+{
+	auto position = sortedHashes.begin();
+	return MergeSorted([&position, &sortedHashes](std::uint64_t& hash) {
+		if (position == sortedHashes.end())return false;
+		hash = *position++;
+		return true;
+	});
+}
+
+std::size_t DeltaEncodedHashes::Merge(const DeltaEncodedHashes& other)
+{
+	Cursor cursor(other);
+	return MergeSorted([&cursor](std::uint64_t& hash) {
+		return cursor.Next(hash);
+	});
+}
+
+template<class Next>
+std::size_t DeltaEncodedHashes::MergeSorted(Next&& next)
+{
+	std::vector<unsigned char> merged;
+	merged.reserve(m_bytes.size() + m_bytes.size() / 2 + 64);
+
+	Cursor current(*this);
+	std::uint64_t currentHash = 0;
+	bool hasCurrent = current.Next(currentHash);
+
+	std::size_t count = 0;
+	std::size_t added = 0;
+	std::uint64_t previous = 0;
+	auto write = [&](const std::uint64_t hash) {
+		AppendVarint(merged, hash - previous);
+		previous = hash;
+		count++;
+	};
+
+	std::uint64_t hash = 0;
+	while (next(hash))
+	{
+		while (hasCurrent && currentHash < hash)
+		{
+			write(currentHash);
+			hasCurrent = current.Next(currentHash);
+		}
+
+		if (hasCurrent && currentHash == hash)continue;
+		write(hash);
+		added++;
+	}
+
+	while (hasCurrent)
+	{
+		write(currentHash);
+		hasCurrent = current.Next(currentHash);
+	}
+
+	if (added == 0)return 0;
+
+	merged.shrink_to_fit();
+	m_bytes.swap(merged);
+	m_count = count;
+
+	return added;
+}
+
+std::size_t DeltaEncodedHashes::GetSize() const
+{
+	return m_count;
+}
+
+std::size_t DeltaEncodedHashes::GetMemoryUsage() const
+{
+	return sizeof(*this) + m_bytes.capacity();
+}
+
+/*
+* TieredHashRuns
+*/
+void TieredHashRuns::Add(const std::vector<std::uint64_t>& sortedHashes)
+{
+	if (sortedHashes.empty())return;
+
+	m_runs.emplace_back();
+	m_runs.back().Merge(sortedHashes);
+
+	while (m_runs.size() >= 2 && m_runs[m_runs.size() - 2].GetSize() <= 2 * m_runs.back().GetSize())
+	{
+		m_runs[m_runs.size() - 2].Merge(m_runs.back());
+		m_runs.pop_back();
+	}
+}
+
+bool TieredHashRuns::Empty() const
+{
+	return m_runs.empty();
+}
+
+std::size_t TieredHashRuns::GetStoredHashes() const
+{
+	std::size_t hashes = 0;
+	for (const auto& run : m_runs)
+	{
+		hashes += run.GetSize();
+	}
+	return hashes;
+}
+
+std::size_t TieredHashRuns::GetNumberOfRuns() const
+{
+	return m_runs.size();
+}
+
+std::size_t TieredHashRuns::GetMemoryUsage() const
+{
+	std::size_t bytes = sizeof(*this) + (m_runs.capacity() - m_runs.size()) * sizeof(DeltaEncodedHashes);
+	for (const auto& run : m_runs)
+	{
+		bytes += run.GetMemoryUsage();
+	}
+	return bytes;
+}
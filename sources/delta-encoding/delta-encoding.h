@@ -0,0 +1,173 @@
+#ifndef DELTA_ENCODING_H
+#define DELTA_ENCODING_H
+
+#include <vector>
+#include <cstdint>
+
+#include "../varint/varint.h"
+
+/*
+	Sorted, unique hashes stored as LEB128 varints of differences
+	between consecutive hashes (first one to 0).
+	Uniformly distributed 64-bit hashes take 5-7 bytes each.
+*/
+class DeltaEncodedHashes
+{
+public:
+	DeltaEncodedHashes();
+
+	/*
+		Merges sorted, unique hashes into the run, hashes already present are skipped.
+		Returns number of hashes which were not present.
+		Rewrites the whole run, cost is linear in its size.
+	*/
+	std::size_t Merge(const std::vector<std::uint64_t>& sortedHashes);
+	std::size_t Merge(const DeltaEncodedHashes& other);
+
+	/*
+		Calls function(std::uint64_t) for every hash in increasing order
+	*/
+	template<class Function>
+	void ForEach(Function&& function) const;
+
+	std::size_t GetSize() const;
+	std::size_t GetMemoryUsage() const;
+
+	/*
+		Decodes run one hash at a time, used to walk several runs together
+	*/
+	class Cursor
+	{
+	public:
+		explicit Cursor(const DeltaEncodedHashes& run);
+
+		bool Next(std::uint64_t& hash);
+
+	private:
+		const unsigned char* m_position;
+		std::size_t m_remaining;
+		std::uint64_t m_hash;
+	};
+
+private:
+	/*
+		next(std::uint64_t&) -> bool yields sorted, unique hashes
+	*/
+	template<class Next>
+	std::size_t MergeSorted(Next&& next);
+
+	std::vector<unsigned char> m_bytes;
+	std::size_t m_count;
+};
+
+/*
+	Size-tiered set of DeltaEncodedHashes runs.
+	Every compaction adds a new run, a run is merged into the previous one
+	while it is at least half of its size. Runs keep geometrically decreasing sizes,
+	so every hash is rewritten O(log n) times instead of on every compaction.
+	Runs may share hashes, ForEach skips the repeated ones.
+*/
+class TieredHashRuns
+{
+public:
+	/*
+		Adds sorted, unique hashes as a new run
+	*/
+	void Add(const std::vector<std::uint64_t>& sortedHashes);
+
+	/*
+		Calls function(std::uint64_t) for every distinct hash in increasing order
+	*/
+	template<class Function>
+	void ForEach(Function&& function) const;
+
+	bool Empty() const;
+
+	/*
+		Sum of run sizes, hash present in several runs is counted for each of them
+	*/
+	std::size_t GetStoredHashes() const;
+	std::size_t GetNumberOfRuns() const;
+	std::size_t GetMemoryUsage() const;
+
+private:
+	std::vector<DeltaEncodedHashes> m_runs;
+};
+
+template<class Function>
+inline void DeltaEncodedHashes::ForEach(Function&& function) const
+{
+	const unsigned char* position = m_bytes.data();
+	std::uint64_t hash = 0;
+	for (std::size_t i = 0; i < m_count; ++i)
+	{
+		hash += ReadVarint(position);
+		function(hash);
+	}
+}
+
+inline DeltaEncodedHashes::Cursor::Cursor(const DeltaEncodedHashes& run)
+	: m_position(run.m_bytes.data()), m_remaining(run.m_count), m_hash(0)
+{
+}
+
+inline bool DeltaEncodedHashes::Cursor::Next(std::uint64_t& hash)
+{
+	if (m_remaining == 0)return false;
+	m_remaining--;
+
+	m_hash += ReadVarint(m_position);
+	hash = m_hash;
+	return true;
+}
+
+template<class Function>
+inline void TieredHashRuns::ForEach(Function&& function) const
+{
+	if (m_runs.size() == 1)
+	{
+		m_runs.front().ForEach(function);
+		return;
+	}
+
+	// Few runs, linear search for the smallest head is cheaper than a heap
+	std::vector<DeltaEncodedHashes::Cursor> cursors;
+	std::vector<std::uint64_t> heads;
+	for (const auto& run : m_runs)
+	{
+		cursors.emplace_back(run);
+		std::uint64_t head = 0;
+		if (!cursors.back().Next(head))
+		{
+			cursors.pop_back();
+			continue;
+		}
+		heads.push_back(head);
+	}
+
+	while (!cursors.empty())
+	{
+		std::size_t smallest = 0;
+		for (std::size_t i = 1; i < heads.size(); ++i)
+		{
+			if (heads[i] < heads[smallest])smallest = i;
+		}
+
+		const std::uint64_t hash = heads[smallest];
+		function(hash);
+
+		// Advance every run positioned on the same hash
+		for (std::size_t i = 0; i < cursors.size();)
+		{
+			if (heads[i] == hash && !cursors[i].Next(heads[i]))
+			{
+				cursors.erase(cursors.begin() + i);
+				heads.erase(heads.begin() + i);
+				continue;
+			}
+			++i;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,35 @@
+#include "duplicate-filter.h"
+
+DuplicateFilter::DuplicateFilter(const std::size_t& bytes)
+{
+	m_setMask = 0;
+	m_lookups = 0;
+	m_hits = 0;
+
+	const std::size_t sets = bytes / (WAYS * sizeof(std::uint64_t));
+	if (sets == 0)return;
+
+	std::size_t powerOfTwo = 1;
+	while (powerOfTwo * 2 <= sets)
+	{
+		powerOfTwo *= 2;
+	}
+
+	m_table.assign(powerOfTwo * WAYS, 0);
+	m_setMask = powerOfTwo - 1;
+}
+
+bool DuplicateFilter::Enabled() const
+{
+	return !m_table.empty();
+}
+
+std::size_t DuplicateFilter::GetLookups() const
+{
+	return m_lookups;
+}
+
+std::size_t DuplicateFilter::GetHits() const
+{
+	return m_hits;
+}
@@ -0,0 +1,67 @@
+#ifndef DUPLICATE_FILTER_H
+#define DUPLICATE_FILTER_H
+
+#include <vector>
+#include <cstdint>
+
+/*
+	Small 2-way set associative table of recently seen hashes,
+	owned by a single worker thread (not thread safe).
+	Tokens found in the filter were already inserted into the shared set
+	by this worker, so they can be dropped without taking any lock.
+*/
+class DuplicateFilter
+{
+public:
+	/*
+		bytes == 0 disables the filter, otherwise size is rounded down to power of two
+	*/
+	explicit DuplicateFilter(const std::size_t& bytes);
+
+	/*
+		Returns true when hash was recently seen,
+		otherwise remembers it and returns false
+	*/
+	bool CheckAndInsert(const std::uint64_t hash);
+
+	bool Enabled() const;
+	std::size_t GetLookups() const;
+	std::size_t GetHits() const;
+
+private:
+	static constexpr std::size_t WAYS = 2;
+
+	std::vector<std::uint64_t> m_table;
+	std::size_t m_setMask;
+	std::size_t m_lookups;
+	std::size_t m_hits;
+};
+
+inline bool DuplicateFilter::CheckAndInsert(const std::uint64_t hash)
+{
+	m_lookups++;
+
+	// 0 marks empty way
+	if (hash == 0)return false;
+
+	std::uint64_t* set = m_table.data() + (hash & m_setMask) * WAYS;
+	if (set[0] == hash)
+	{
+		m_hits++;
+		return true;
+	}
+	if (set[1] == hash)
+	{
+		// Keep most recently used hash in the first way
+		set[1] = set[0];
+		set[0] = hash;
+		m_hits++;
+		return true;
+	}
+
+	set[1] = set[0];
+	set[0] = hash;
+	return false;
+}
+
+#endif
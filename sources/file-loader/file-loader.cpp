@@ -3,18 +3,25 @@
 #include <utility>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 FileLoader::FileLoader()
 {
 	m_initialized = false;
 	m_path = "";
 	m_fileLength = 0;
+	m_rangeStart = 0;
+	m_rangeEnd = 0;
+	m_chunkSize = 0;
+	m_numberOfChunks = 0;
+	m_nextChunk = 0;
 }
 
 FileLoader::FileLoader(std::filesystem::path && path) : FileLoader()
 {
 	m_path = std::move(path);
 	if (CalculateFileLength() != 0)m_initialized = true;
+	m_rangeEnd = (std::size_t)m_fileLength;
 }
 
 FileLoader::FileLoader(const std::string& fileName) : FileLoader(std::filesystem::path(fileName))
@@ -31,46 +38,139 @@ std::filesystem::path FileLoader::GetFilePath() const
 	return m_path;
 }
 
-void FileLoader::DivideIntoBlocks(const std::size_t & blocks, const char& optionalSeparator)
+void FileLoader::SetRange(const std::size_t& start, const std::size_t& end)
 {
-	if (m_fileLength == 0)return;
-	if (blocks == 0)
+	m_rangeEnd = std::min(end, (std::size_t)m_fileLength);
+	m_rangeStart = std::min(start, m_rangeEnd);
+}
+
+std::size_t FileLoader::GetRangeLength() const
+{
+	return m_rangeEnd - m_rangeStart;
+}
+
+void FileLoader::DivideIntoChunks(const std::size_t& chunkSize, const std::size_t& workers)
+{
+	constexpr std::size_t minimalAutoChunkSize = 256 * 1024;
+	constexpr std::size_t maximalAutoChunkSize = 16 * 1024 * 1024;
+
+	m_chunkSize = chunkSize;
+	if (m_chunkSize == 0)
 	{
-		std::cerr << "Number of blocks cannot be equal to 0.";
-		return;
+		// Few chunks per worker so slow chunks do not leave other threads idle at the tail
+		const std::size_t chunksPerWorker = 8;
+		m_chunkSize = (m_rangeEnd - m_rangeStart) / (std::max<std::size_t>(workers, 1) * chunksPerWorker);
+		m_chunkSize = std::clamp(m_chunkSize, minimalAutoChunkSize, maximalAutoChunkSize);
 	}
-	m_blocksRanges.clear();
-	m_blocksRanges.reserve(blocks);
 
-	const std::size_t charactersInBlock = (std::size_t)std::ceil((double)m_fileLength / (double)blocks);
+	m_numberOfChunks = (m_rangeEnd - m_rangeStart + m_chunkSize - 1) / m_chunkSize;
+	m_nextChunk = 0;
+}
+
+std::size_t FileLoader::GetChunkSize() const
+{
+	return m_chunkSize;
+}
+
+std::size_t FileLoader::GetNumberOfChunks() const
+{
+	return m_numberOfChunks;
+}
 
-	std::ifstream file(m_path);
+std::optional<std::pair<std::size_t, std::size_t>> FileLoader::ClaimChunk()
+{
+	const std::size_t chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed);
+	if (chunk >= m_numberOfChunks)return {};
 
 	/*
 		Using STD convention
-		block is a range described by:
+		chunk is a range described by:
 		[start; end)
 	*/
-	
-	std::size_t blockStart = 0;
-	std::size_t blockEnd = charactersInBlock;
+	const std::size_t start = m_rangeStart + chunk * m_chunkSize;
+	const std::size_t end = std::min(start + m_chunkSize, m_rangeEnd);
+
+	return std::make_pair(start, end);
+}
+
+std::string_view FileLoader::LoadChunk(std::ifstream& file, const std::pair<std::size_t, std::size_t>& chunk, std::string& buffer,
+	const ByteClassTable& byteClasses, const std::size_t& extraTokens,
+	const std::function<std::size_t(std::string_view)>& countTokens) const
+{
+	auto isRecordEnd = [&byteClasses](const char character) {
+		return byteClasses[(unsigned char)character] == RECORD_END;
+	};
+
+	constexpr std::size_t overhangStep = 256;
 
-	while (blockStart <= (std::size_t)m_fileLength)
+	buffer.clear();
+	if (chunk.second <= chunk.first)return {};
+
+	// One character before chunk tells whether first record started in previous chunk
+	const std::size_t readStart = chunk.first == 0 ? 0 : chunk.first - 1;
+
+	file.clear();
+	file.seekg(readStart);
+	buffer.resize(chunk.second - readStart);
+	file.read(buffer.data(), buffer.size());
+	buffer.resize((std::size_t)file.gcount());
+	if (buffer.empty())return {};
+
+	std::size_t wordsStart = 0;
+	if (chunk.first != 0)
 	{
-		while (!file.eof() && !std::isspace(file.seekg(blockEnd).peek()))
+		while (wordsStart < buffer.size() && !isRecordEnd(buffer[wordsStart]))
 		{
-			blockEnd++;
+			wordsStart++;
 		}
-		m_blocksRanges.push_back(std::make_pair(blockStart, blockEnd));
-		blockStart = blockEnd;
-		blockEnd = blockStart + charactersInBlock;
+		if (wordsStart == buffer.size())return {};
 	}
-	file.close();
-}
 
-const std::vector<std::pair<std::size_t, std::size_t>>& FileLoader::GetBlocks() const
-{
-	return m_blocksRanges;
+	// Finish last record, it may continue past chunk end,
+	// then read following records until they hold extraTokens tokens
+	bool inRecord = !isRecordEnd(buffer.back());
+	bool finishing = inRecord;
+	std::size_t recordStart = 0;
+	std::size_t missingTokens = extraTokens;
+	while ((finishing || missingTokens != 0) && file)
+	{
+		const std::size_t previousSize = buffer.size();
+		buffer.resize(previousSize + overhangStep);
+		file.read(buffer.data() + previousSize, overhangStep);
+		buffer.resize(previousSize + (std::size_t)file.gcount());
+
+		bool done = false;
+		for (std::size_t i = previousSize; i < buffer.size(); ++i)
+		{
+			if (!isRecordEnd(buffer[i]))
+			{
+				if (!inRecord)recordStart = i;
+				inRecord = true;
+				continue;
+			}
+
+			if (inRecord)
+			{
+				inRecord = false;
+				if (finishing)finishing = false;
+				else
+				{
+					const std::size_t tokens = countTokens ? countTokens(std::string_view(buffer).substr(recordStart, i - recordStart)) : 1;
+					missingTokens -= std::min(tokens, missingTokens);
+				}
+			}
+
+			if (!finishing && missingTokens == 0)
+			{
+				buffer.resize(i);
+				done = true;
+				break;
+			}
+		}
+		if (done)break;
+	}
+
+	return std::string_view(buffer).substr(wordsStart);
 }
 
 bool FileLoader::Good() const
@@ -88,7 +188,7 @@ std::streamsize FileLoader::CalculateFileLength()
 
 	m_fileLength = 0;
 
-	std::ifstream file(m_path);
+	std::ifstream file(m_path, std::ios::binary);
 	if (!file.good())return m_fileLength;
 
 	while (file.ignore(std::numeric_limits<std::streamsize>::max()))
@@ -2,7 +2,14 @@
 #define FILE_LOADER_H
 
 #include <string>
+#include <string_view>
 #include <filesystem>
+#include <fstream>
+#include <optional>
+#include <atomic>
+#include <functional>
+
+#include "../tokenizer/tokenizer.h"
 
 class FileLoader
 {
@@ -22,10 +29,43 @@ public:
 	std::filesystem::path GetFilePath()const;
 
 	/*
-		Default implementation uses std::is_space function
+		Restricts processing to bytes [start; end) of the file, end is clamped to file length.
+		Word crossing start belongs to the previous range, word crossing end to this one.
+		Has to be called before DivideIntoChunks.
+	*/
+	void SetRange(const std::size_t& start, const std::size_t& end);
+
+	/*
+		Number of bytes in processed range, sum of all chunk sizes
+	*/
+	std::size_t GetRangeLength() const;
+
+	/*
+		Splits file into fixed size chunks which are claimed by workers at runtime.
+		chunkSize == 0 selects size automatically from file length and number of workers.
+	*/
+	void DivideIntoChunks(const std::size_t& chunkSize, const std::size_t& workers);
+	std::size_t GetChunkSize() const;
+	std::size_t GetNumberOfChunks() const;
+
+	/*
+		Thread safe, returns [start; end) range of the next unclaimed chunk
+		or empty optional when all chunks were already claimed
+	*/
+	std::optional<std::pair<std::size_t, std::size_t>> ClaimChunk();
+
+	/*
+		Reads chunk into buffer and aligns it to RECORD_END bytes of byteClasses:
+		record crossing chunk start belongs to the previous chunk,
+		record crossing chunk end is read until its last character.
+		extraTokens - number of tokens read past the chunk, lets n-grams starting in this chunk be completed.
+		countTokens(record) tells how many tokens a following record holds, records without
+		a token (empty csv field) don't count. Without countTokens every non-empty record is one token.
+		Returns view of the aligned part of buffer.
 	*/
-	void DivideIntoBlocks(const std::size_t& blocks, const char & optionalSeparator = 0);
-	const std::vector<std::pair<std::size_t, std::size_t>> & GetBlocks() const;
+	std::string_view LoadChunk(std::ifstream& file, const std::pair<std::size_t, std::size_t>& chunk, std::string& buffer,
+		const ByteClassTable& byteClasses = WhitespaceSeparators::BYTE_CLASSES, const std::size_t& extraTokens = 0,
+		const std::function<std::size_t(std::string_view)>& countTokens = nullptr) const;
 
 	bool Good() const;
 
@@ -39,7 +79,11 @@ private:
 	std::filesystem::path m_path;
 	std::streamsize m_fileLength;
 
-	std::vector<std::pair<std::size_t, std::size_t>> m_blocksRanges;
+	std::size_t m_rangeStart;
+	std::size_t m_rangeEnd;
+	std::size_t m_chunkSize;
+	std::size_t m_numberOfChunks;
+	std::atomic<std::size_t> m_nextChunk;
 };
 
 #endif
\ No newline at end of file
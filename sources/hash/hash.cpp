@@ -0,0 +1 @@
+#include "hash.h"
\ No newline at end of file
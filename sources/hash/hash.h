@@ -0,0 +1,211 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <functional>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+/*
+	Constants taken from wyhash (public domain, Wang Yi)
+*/
+constexpr std::uint64_t HASH_SECRET[4] = {
+	0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+	0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
+
+/*
+	Multiplies a and b to a 128-bit product and folds it back to 64 bits
+*/
+inline std::uint64_t HashMix(std::uint64_t a, std::uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+	const __uint128_t product = (__uint128_t)a * b;
+	return (std::uint64_t)product ^ (std::uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	std::uint64_t high = 0;
+	const std::uint64_t low = _umul128(a, b, &high);
+	return low ^ high;
+#else
+	const std::uint64_t aHigh = a >> 32, aLow = (std::uint32_t)a;
+	const std::uint64_t bHigh = b >> 32, bLow = (std::uint32_t)b;
+	const std::uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow;
+	const std::uint64_t lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+	const std::uint64_t middle = (lowLow >> 32) + (std::uint32_t)highLow + (std::uint32_t)lowHigh;
+	const std::uint64_t low = (middle << 32) | (std::uint32_t)lowLow;
+	const std::uint64_t high = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+	return low ^ high;
+#endif
+}
+
+/*
+	wyhash-class 64-bit string hash which can be fed one byte at a time.
+	Bytes are packed into little-endian 8 byte words, so for every input
+	the result is equal to WyHashPolicy::Hash.
+*/
+class StreamingHasher
+{
+public:
+	StreamingHasher();
+
+	void Reset();
+	void Update(const unsigned char byte);
+	std::uint64_t Digest() const;
+
+	std::size_t GetLength() const;
+
+private:
+	std::uint64_t m_state;
+	std::uint64_t m_word;
+	unsigned int m_shift;
+	std::size_t m_length;
+};
+
+/*
+	Hash policy used by ConcurentSet:
+	- Hash      - fast, well mixed 64-bit string hash
+	- Bucket    - multiply-shift on the high 32 bits, no modulo
+	- Slot      - low 32 bits, independent of the bits used by Bucket
+	- Partition - multiply-shift on the low 32 bits, splits hashes between
+	              processes without emptying any of their buckets
+*/
+struct WyHashPolicy
+{
+	static std::uint64_t Hash(std::string_view str);
+	static std::size_t Bucket(const std::uint64_t hash, const std::size_t buckets);
+	static std::size_t Slot(const std::uint64_t hash);
+	static std::size_t Partition(const std::uint64_t hash, const std::size_t partitions);
+};
+
+/*
+	Previous behaviour: std::hash with modulo bucket selection
+	and identity slot hash. Kept for comparison in benchmarks.
+*/
+struct StdHashPolicy
+{
+	static std::uint64_t Hash(std::string_view str);
+	static std::size_t Bucket(const std::uint64_t hash, const std::size_t buckets);
+	static std::size_t Slot(const std::uint64_t hash);
+	static std::size_t Partition(const std::uint64_t hash, const std::size_t partitions);
+};
+
+/*
+	Adapts HashPolicy::Slot to the Hash requirement of std containers
+*/
+template<class HashPolicy>
+struct SlotHasher
+{
+	std::size_t operator()(const std::uint64_t hash) const
+	{
+		return HashPolicy::Slot(hash);
+	}
+};
+
+/*
+* StreamingHasher
+*/
+inline StreamingHasher::StreamingHasher()
+{
+	Reset();
+}
+
+inline void StreamingHasher::Reset()
+{
+	m_state = HASH_SECRET[0];
+	m_word = 0;
+	m_shift = 0;
+	m_length = 0;
+}
+
+inline void StreamingHasher::Update(const unsigned char byte)
+{
+	m_word |= (std::uint64_t)byte << m_shift;
+	m_shift += 8;
+	m_length++;
+
+	if (m_shift == 64)
+	{
+		m_state = HashMix(m_word ^ HASH_SECRET[1], m_state ^ HASH_SECRET[2]);
+		m_word = 0;
+		m_shift = 0;
+	}
+}
+
+inline std::uint64_t StreamingHasher::Digest() const
+{
+	return HashMix(HASH_SECRET[1] ^ m_length, HashMix(m_word ^ HASH_SECRET[1], m_state ^ HASH_SECRET[3]));
+}
+
+inline std::size_t StreamingHasher::GetLength() const
+{
+	return m_length;
+}
+
+/*
+* WyHashPolicy
+*/
+inline std::uint64_t WyHashPolicy::Hash(std::string_view str)
+{
+	// Assumes little-endian host, same as StreamingHasher byte packing
+	std::uint64_t state = HASH_SECRET[0];
+	const char* data = str.data();
+	std::size_t remaining = str.size();
+
+	while (remaining >= 8)
+	{
+		std::uint64_t word;
+		std::memcpy(&word, data, 8);
+		state = HashMix(word ^ HASH_SECRET[1], state ^ HASH_SECRET[2]);
+		data += 8;
+		remaining -= 8;
+	}
+
+	std::uint64_t tail = 0;
+	std::memcpy(&tail, data, remaining);
+
+	return HashMix(HASH_SECRET[1] ^ str.size(), HashMix(tail ^ HASH_SECRET[1], state ^ HASH_SECRET[3]));
+}
+
+inline std::size_t WyHashPolicy::Bucket(const std::uint64_t hash, const std::size_t buckets)
+{
+	return (std::size_t)(((hash >> 32) * (std::uint64_t)buckets) >> 32);
+}
+
+inline std::size_t WyHashPolicy::Slot(const std::uint64_t hash)
+{
+	return (std::size_t)(hash & 0xffffffffull);
+}
+
+inline std::size_t WyHashPolicy::Partition(const std::uint64_t hash, const std::size_t partitions)
+{
+	return (std::size_t)(((hash & 0xffffffffull) * (std::uint64_t)partitions) >> 32);
+}
+
+/*
+* StdHashPolicy
+*/
+inline std::uint64_t StdHashPolicy::Hash(std::string_view str)
+{
+	return std::hash<std::string_view>{}(str);
+}
+
+inline std::size_t StdHashPolicy::Bucket(const std::uint64_t hash, const std::size_t buckets)
+{
+	return (std::size_t)(hash % buckets);
+}
+
+inline std::size_t StdHashPolicy::Slot(const std::uint64_t hash)
+{
+	return (std::size_t)hash;
+}
+
+inline std::size_t StdHashPolicy::Partition(const std::uint64_t hash, const std::size_t partitions)
+{
+	return (std::size_t)(hash % partitions);
+}
+
+#endif
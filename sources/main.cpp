@@ -1,13 +1,44 @@
 #include "tests/tests.h"
+#include "utils/utils.h"
 #include "pipeline/pipeline.h"
+#include "shard-file/shard-file.h"
+
+/*
+	merge [output] [shard...]
+*/
+int Merge(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		std::cout << "Expected output file and at least one shard file.";
+		printHelp();
+		return -1;
+	}
+
+	const std::vector<std::filesystem::path> inputs(argv + 3, argv + argc);
+	std::uint64_t distinct = 0;
+	if (!MergeShardFiles(inputs, argv[2], distinct))return -1;
+
+	std::cout << "Number of distinct words: " << distinct;
+
+	// Partial inputs were reported by MergeShardFiles, the merged shard keeps the flag
+	if (ShardReader(argv[2]).GetSettings().m_partial)
+	{
+		std::cout << " (partial)";
+		return 2;
+	}
+	return 0;
+}
 
 
 int main(int argc, char* argv[])
 {
+	if (argc > 1 && std::string(argv[1]) == "merge")return Merge(argc, argv);
+
 	std::unordered_map<ArgumentType, std::string> inputArguments = ParseArguments(argc, argv);
 
 	if (inputArguments.find(ArgumentType::TEST) != inputArguments.end()) {
-		Test(inputArguments);
+		if (!Test(inputArguments))return -1;
 	}
 	else
 	{
@@ -15,6 +46,11 @@ int main(int argc, char* argv[])
 		if (!task.OnInit(inputArguments))return -1;
 		task.Run();
 		task.OnExit();
+
+		// Result was printed, but part of the input could not be read
+		if (task.GetUnreadBytes() != 0)return -1;
+		// Result was printed, but counting was stopped by signal
+		if (task.IsPartial())return 2;
 	}
 
 	return 0;
@@ -0,0 +1,72 @@
+#include "min-hash.h"
+#include <algorithm>
+#include <limits>
+
+MinHashSketch::MinHashSketch(const std::size_t& size)
+{
+	m_size = std::max<std::size_t>(size, 2);
+	m_threshold = std::numeric_limits<std::uint64_t>::max();
+	m_hashes.reserve(m_size + 1);
+}
+
+double MinHashSketch::GetCardinality() const
+{
+	std::lock_guard lock(m_mutex);
+	if (m_hashes.size() < m_size)return (double)m_hashes.size();
+
+	return EstimateCardinality(m_size, m_hashes.back());
+}
+
+std::size_t MinHashSketch::GetMemoryUsage() const
+{
+	std::lock_guard lock(m_mutex);
+	return sizeof(*this) + m_hashes.capacity() * sizeof(std::uint64_t);
+}
+
+SetComparison MinHashSketch::Compare(const MinHashSketch& first, const MinHashSketch& second)
+{
+	SetComparison comparison;
+	comparison.m_first = (std::uint64_t)(first.GetCardinality() + 0.5);
+	comparison.m_second = (std::uint64_t)(second.GetCardinality() + 0.5);
+
+	// Jaccard = I / (A + B - I)
+	const double jaccard = GetJaccard(first, second);
+	const double intersection = jaccard * (double)(comparison.m_first + comparison.m_second) / (1.0 + jaccard);
+	comparison.m_intersection = std::min({ (std::uint64_t)(intersection + 0.5), comparison.m_first, comparison.m_second });
+
+	return comparison;
+}
+
+double MinHashSketch::GetJaccard(const MinHashSketch& first, const MinHashSketch& second)
+{
+	std::scoped_lock lock(first.m_mutex, second.m_mutex);
+
+	// The k smallest hashes of the union are all kept by one of the sketches
+	const std::size_t size = std::min(first.m_size, second.m_size);
+	const auto& a = first.m_hashes;
+	const auto& b = second.m_hashes;
+
+	std::size_t i = 0, j = 0, taken = 0, shared = 0;
+	while (taken < size && (i < a.size() || j < b.size()))
+	{
+		if (j == b.size() || (i < a.size() && a[i] < b[j]))i++;
+		else if (i == a.size() || b[j] < a[i])j++;
+		else
+		{
+			i++;
+			j++;
+			shared++;
+		}
+		taken++;
+	}
+
+	if (taken == 0)return 0.0;
+	return (double)shared / (double)taken;
+}
+
+double MinHashSketch::EstimateCardinality(const std::size_t& size, const std::uint64_t maximum)
+{
+	// k-th smallest of n uniform hashes is expected at k / n of the hash range
+	constexpr double hashRange = 18446744073709551616.0;
+	return (double)(size - 1) * hashRange / ((double)maximum + 1.0);
+}
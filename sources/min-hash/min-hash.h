@@ -0,0 +1,74 @@
+#ifndef MIN_HASH_H
+#define MIN_HASH_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+#include "../tokenizer/tokenizer.h"
+#include "../set-comparison/set-comparison.h"
+
+/*
+	Bottom-k MinHash sketch: keeps only the size smallest distinct hashes,
+	so memory is constant regardless of input size.
+	- Cardinality is estimated from the k-th smallest hash (KMV),
+	  exact while fewer than size distinct hashes were seen
+	- Jaccard similarity of two sketches is the share of the size smallest
+	  hashes of their union which are present in both
+	Thread safe. Most hashes are rejected by one relaxed atomic load,
+	lock is taken only by hashes smaller than the current maximum.
+*/
+class MinHashSketch
+{
+public:
+	explicit MinHashSketch(const std::size_t& size);
+
+	/*
+		Same interface as ConcurentSet, so ThreadScheduler can fill both
+	*/
+	void Insert(const Token& token);
+	void InsertHash(const std::uint64_t hash);
+
+	double GetCardinality() const;
+	std::size_t GetMemoryUsage() const;
+
+	/*
+		Estimated sizes of both sets and of their intersection
+	*/
+	static SetComparison Compare(const MinHashSketch& first, const MinHashSketch& second);
+
+	static double GetJaccard(const MinHashSketch& first, const MinHashSketch& second);
+
+private:
+	static double EstimateCardinality(const std::size_t& size, const std::uint64_t maximum);
+
+	std::size_t m_size;
+	// Largest kept hash once sketch is full, bigger hashes are rejected without lock
+	std::atomic<std::uint64_t> m_threshold;
+	mutable std::mutex m_mutex;
+	// Sorted ascending, unique
+	std::vector<std::uint64_t> m_hashes;
+};
+
+inline void MinHashSketch::Insert(const Token& token)
+{
+	InsertHash(token.m_hash);
+}
+
+inline void MinHashSketch::InsertHash(const std::uint64_t hash)
+{
+	if (hash >= m_threshold.load(std::memory_order_relaxed))return;
+
+	std::lock_guard lock(m_mutex);
+	const auto position = std::lower_bound(m_hashes.begin(), m_hashes.end(), hash);
+	if (position != m_hashes.end() && *position == hash)return;
+	if (m_hashes.size() == m_size && position == m_hashes.end())return;
+
+	m_hashes.insert(position, hash);
+	if (m_hashes.size() > m_size)m_hashes.pop_back();
+	if (m_hashes.size() == m_size)m_threshold.store(m_hashes.back(), std::memory_order_relaxed);
+}
+
+#endif
@@ -1,15 +1,46 @@
 #include "pipeline.h"
-#include "../thread-scheduler/thread-scheduler.h"
 #include "../utils/utils.h" // printHelp
+#include "../shard-file/shard-file.h"
+#include "../word-export/word-export.h"
+#include "../set-comparison/set-comparison.h"
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <fstream>
+
+static constexpr std::size_t DEFAULT_SKETCH_SIZE = 1024;
+
+static void PrintComparison(std::ostream& log, const SetComparison& comparison, const bool estimated)
+{
+	const char* count = estimated ? "Estimated number of distinct words " : "Number of distinct words ";
+	log << count << "in first file: " << comparison.m_first
+		<< "\n" << count << "in second file: " << comparison.m_second
+		<< "\n" << count << "in both files: " << comparison.m_intersection
+		<< "\n" << count << "only in first file: " << comparison.GetFirstOnly()
+		<< "\n" << count << "only in second file: " << comparison.GetSecondOnly()
+		<< "\n" << count << "in any file: " << comparison.GetUnion()
+		<< "\n" << (estimated ? "Estimated Jaccard similarity: " : "Jaccard similarity: ") << comparison.GetJaccard();
+}
 
 bool Pipeline::OnInit(const std::unordered_map<ArgumentType, std::string>& args)
 {
 	m_inputArguments = args;
+	m_log = &std::cout;
+	m_partial = false;
+	m_unreadBytes = 0;
+	m_distinct = 0;
+	m_exported = 0;
+
+	if (m_inputArguments.find(ArgumentType::EXPORT) != m_inputArguments.end())
+	{
+		m_exportPath = m_inputArguments.at(ArgumentType::EXPORT);
+		if (m_exportPath == "-")m_log = &std::cerr;
+	}
 
 	//Try to parse input arguments
 	if (m_inputArguments == std::unordered_map<ArgumentType, std::string>())
 	{
-		std::cout << "Incorrect number of arguments. Expected 1, 2  or 3 arguments.";
+		std::cout << "Incorrect number of arguments.";
 		printHelp();
 		return false;
 	}
@@ -29,41 +60,407 @@ bool Pipeline::OnInit(const std::unordered_map<ArgumentType, std::string>& args)
 		return false;
 	}
 
-	//Set number of threads / blocks
-	m_numberOfBlocks = 50;
+	//Set number of threads
+	m_settings.m_threads = std::max(std::thread::hardware_concurrency(), 1u);
 	if (m_inputArguments.find(ArgumentType::THREADS) != m_inputArguments.end())
 	{
 		auto argumentConversion = ConvertArgument<std::size_t>(m_inputArguments.at(ArgumentType::THREADS));
+		if (argumentConversion.has_value() && argumentConversion.value() != 0)
+		{
+			m_settings.m_threads = argumentConversion.value();
+		}
+	}
+
+	//Set chunk size, 0 means automatic
+	std::size_t chunkSize = 0;
+	if (m_inputArguments.find(ArgumentType::CHUNK_SIZE) != m_inputArguments.end())
+	{
+		auto argumentConversion = ConvertArgument<std::size_t>(m_inputArguments.at(ArgumentType::CHUNK_SIZE));
 		if (argumentConversion.has_value())
 		{
-			m_numberOfBlocks = argumentConversion.value();
+			chunkSize = argumentConversion.value() * 1024;
 		}
 	}
-	std::cout << "Running with " << m_numberOfBlocks << " threads" << std::endl;
 
-	// Divide into blocks
-	m_loader->DivideIntoBlocks(m_numberOfBlocks);
+	//Set per thread duplicate filter size, 0 means disabled
+	m_settings.m_filterBytes = 0;
+	if (m_inputArguments.find(ArgumentType::FILTER_SIZE) != m_inputArguments.end())
+	{
+		auto argumentConversion = ConvertArgument<std::size_t>(m_inputArguments.at(ArgumentType::FILTER_SIZE));
+		if (argumentConversion.has_value())
+		{
+			m_settings.m_filterBytes = argumentConversion.value() * 1024;
+		}
+	}
+
+	//Set separators and extracted column
+	if (m_inputArguments.find(ArgumentType::SEPARATORS) != m_inputArguments.end())
+	{
+		const std::string& mode = m_inputArguments.at(ArgumentType::SEPARATORS);
+		if (mode == "space")m_settings.m_separatorMode = SeparatorMode::WHITESPACE;
+		else if (mode == "punct")m_settings.m_separatorMode = SeparatorMode::PUNCTUATION;
+		else if (mode == "csv")m_settings.m_separatorMode = SeparatorMode::CSV;
+		else if (mode == "tsv")m_settings.m_separatorMode = SeparatorMode::TSV;
+		else
+		{
+			std::cout << "Unknown separators " << mode << ".";
+			printHelp();
+			return false;
+		}
+	}
+
+	if (m_inputArguments.find(ArgumentType::FIELD) != m_inputArguments.end())
+	{
+		auto argumentConversion = ConvertArgument<std::size_t>(m_inputArguments.at(ArgumentType::FIELD));
+		if (!argumentConversion.has_value() || argumentConversion.value() == 0)
+		{
+			std::cout << "Column number has to be greater than 0.";
+			printHelp();
+			return false;
+		}
+		m_settings.m_field = argumentConversion.value() - 1;
+	}
+
+	//Set n-gram length
+	if (m_inputArguments.find(ArgumentType::NGRAM) != m_inputArguments.end())
+	{
+		auto argumentConversion = ConvertArgument<std::size_t>(m_inputArguments.at(ArgumentType::NGRAM));
+		if (!argumentConversion.has_value() || argumentConversion.value() == 0)
+		{
+			std::cout << "N-gram length has to be greater than 0.";
+			printHelp();
+			return false;
+		}
+		m_settings.m_ngram = argumentConversion.value();
+		if (m_settings.m_ngram > 1)*m_log << "Counting " << m_settings.m_ngram << "-grams" << std::endl;
+	}
+
+	//Set hash partition "index/partitions"
+	if (m_inputArguments.find(ArgumentType::PARTITION) != m_inputArguments.end())
+	{
+		const std::string& partition = m_inputArguments.at(ArgumentType::PARTITION);
+		const auto separator = partition.find('/');
+		std::optional<std::size_t> index, partitions;
+		if (separator != partition.npos)
+		{
+			index = ConvertArgument<std::size_t>(partition.substr(0, separator));
+			partitions = ConvertArgument<std::size_t>(partition.substr(separator + 1));
+		}
+		if (!index.has_value() || !partitions.has_value() || index.value() >= partitions.value())
+		{
+			std::cout << "Incorrect partition " << partition << ".";
+			printHelp();
+			return false;
+		}
+		m_settings.m_partition = index.value();
+		m_settings.m_partitions = partitions.value();
+		*m_log << "Counting hash partition " << m_settings.m_partition << " of " << m_settings.m_partitions << std::endl;
+	}
+
+	//Set byte range "start:end"
+	if (m_inputArguments.find(ArgumentType::RANGE) != m_inputArguments.end())
+	{
+		const std::string& range = m_inputArguments.at(ArgumentType::RANGE);
+		const auto separator = range.find(':');
+		std::optional<std::size_t> start, end;
+		if (separator != range.npos)
+		{
+			start = ConvertArgument<std::size_t>(range.substr(0, separator));
+			end = ConvertArgument<std::size_t>(range.substr(separator + 1));
+		}
+		if (!start.has_value() || !end.has_value() || start.value() > end.value())
+		{
+			std::cout << "Incorrect byte range " << range << ".";
+			printHelp();
+			return false;
+		}
+		m_loader->SetRange(start.value(), end.value());
+		*m_log << "Counting byte range [" << start.value() << "; " << end.value() << ")" << std::endl;
+	}
+
+	if (m_inputArguments.find(ArgumentType::OUTPUT) != m_inputArguments.end())
+	{
+		m_outputPath = m_inputArguments.at(ArgumentType::OUTPUT);
+	}
+
+	//Set second input, its hashes are tagged in the shared set
+	if (m_inputArguments.find(ArgumentType::COMPARE) != m_inputArguments.end())
+	{
+		if (!m_outputPath.empty() || m_inputArguments.find(ArgumentType::RANGE) != m_inputArguments.end())
+		{
+			std::cout << "Comparison cannot be combined with shard output (-o) or byte range (-r).";
+			printHelp();
+			return false;
+		}
+
+		const std::string& comparePath = m_inputArguments.at(ArgumentType::COMPARE);
+		m_compareLoader = std::make_unique<FileLoader>(comparePath);
+		if (!m_compareLoader->Good())
+		{
+			std::cerr << "Cannot load file " << comparePath << std::endl;
+			return false;
+		}
+		*m_log << "Comparing with " << comparePath << std::endl;
+	}
+
+	//Set sketch size, sketch mode replaces the set
+	if (m_inputArguments.find(ArgumentType::SKETCH) != m_inputArguments.end())
+	{
+		auto argumentConversion = ConvertArgument<std::size_t>(m_inputArguments.at(ArgumentType::SKETCH));
+		if (!argumentConversion.has_value())
+		{
+			std::cout << "Incorrect sketch size.";
+			printHelp();
+			return false;
+		}
+		if (!m_outputPath.empty() || !m_exportPath.empty())
+		{
+			std::cout << "Sketch cannot be combined with shard output (-o) or export (-e).";
+			printHelp();
+			return false;
+		}
+
+		const std::size_t sketchSize = argumentConversion.value() != 0 ? argumentConversion.value() : DEFAULT_SKETCH_SIZE;
+		m_sketch = std::make_unique<MinHashSketch>(sketchSize);
+		if (m_compareLoader)m_compareSketch = std::make_unique<MinHashSketch>(sketchSize);
+		*m_log << "Estimating with MinHash sketch of " << sketchSize << " hashes" << std::endl;
+	}
+
+	//Set progress report interval in seconds, 0 means no reports
+	m_progressInterval = std::chrono::milliseconds(0);
+	if (m_inputArguments.find(ArgumentType::PROGRESS) != m_inputArguments.end())
+	{
+		auto argumentConversion = ConvertArgument<std::size_t>(m_inputArguments.at(ArgumentType::PROGRESS));
+		if (argumentConversion.has_value())
+		{
+			m_progressInterval = std::chrono::milliseconds(argumentConversion.value() * 1000);
+		}
+	}
+	m_progress = std::make_unique<ProgressCounters>(m_settings.m_threads);
+	m_settings.m_progress = m_progress.get();
+
+	// Divide into chunks
+	m_loader->DivideIntoChunks(chunkSize, m_settings.m_threads);
+	*m_log << "Running with " << m_settings.m_threads << " threads, "
+		<< m_loader->GetNumberOfChunks() << " chunks of " << m_loader->GetChunkSize() / 1024 << " KB" << std::endl;
+	if (m_compareLoader)m_compareLoader->DivideIntoChunks(chunkSize, m_settings.m_threads);
+	m_totalBytes = m_loader->GetRangeLength() + (m_compareLoader ? m_compareLoader->GetRangeLength() : 0);
+
+	if (m_sketch)return true;
 
 	//Create concurent set
-	m_concurentSet = std::make_unique<ConcurentSet<std::string>>(m_numberOfBlocks);
-	m_loader->GetFilePath();
-	m_loader->GetFileLength();
+	m_concurentSet = std::make_unique<ConcurentSet<std::string_view>>(m_settings.m_threads);
+
+	//Set memory budget, 0 means unlimited
+	m_maxMemory = 0;
+	if (m_inputArguments.find(ArgumentType::MAX_MEMORY) != m_inputArguments.end())
+	{
+		auto argumentConversion = ConvertArgument<std::size_t>(m_inputArguments.at(ArgumentType::MAX_MEMORY));
+		if (argumentConversion.has_value())
+		{
+			m_maxMemory = argumentConversion.value() * 1024 * 1024;
+		}
+	}
+	m_concurentSet->SetMemoryBudget(m_maxMemory);
+	m_settings.m_keepWords = !m_exportPath.empty();
+	m_concurentSet->SetKeepWords(m_settings.m_keepWords);
 
 	return true;
 }
 
 void Pipeline::Run()
 {
+	// Signal lets workers finish current chunks instead of losing the whole run
+	InstallStopHandler();
+
+	ProgressReporter reporter;
+	if (m_progressInterval.count() != 0)
+	{
+		reporter.Start(*m_progress, m_totalBytes, m_progressInterval, *m_log,
+			[this]() -> std::uint64_t {
+				if (m_sketch)return (std::uint64_t)m_sketch->GetCardinality();
+				return m_concurentSet->GetSizeEstimate();
+			},
+			[this]() -> std::size_t {
+				if (m_sketch)return m_sketch->GetMemoryUsage() + (m_compareSketch ? m_compareSketch->GetMemoryUsage() : 0);
+				return m_concurentSet->GetMemoryUsageEstimate();
+			});
+	}
+
+	// Tags are needed only when both inputs share the set
+	m_statistics = Count(*m_loader, m_sketch.get(), m_compareLoader ? FIRST_INPUT : 0);
+
+	if (m_compareLoader)
+	{
+		const WorkerStatistics statistics = Count(*m_compareLoader, m_compareSketch.get(), SECOND_INPUT);
+		m_statistics.m_words += statistics.m_words;
+		m_statistics.m_filterLookups += statistics.m_filterLookups;
+		m_statistics.m_filterHits += statistics.m_filterHits;
+		m_statistics.m_unreadBytes += statistics.m_unreadBytes;
+	}
+
+	reporter.Stop();
+	m_partial = StopRequested();
+	// Without stop every chunk was claimed, so bytes missing from progress were not read,
+	// that includes inputs no worker could open
+	m_unreadBytes = m_partial ? m_statistics.m_unreadBytes : m_totalBytes - m_progress->GetBytes();
+}
+
+WorkerStatistics Pipeline::Count(FileLoader& loader, MinHashSketch* sketch, const std::uint64_t membershipTag)
+{
+	WorkerSettings settings = m_settings;
+	settings.m_membershipTag = sketch == nullptr ? membershipTag : 0;
+
 	ThreadScheduler scheduler;
-	// Create threads and assign them to specyfic blocks
-	scheduler.Start(*m_concurentSet, *m_loader);
+	// Create threads, they claim chunks on their own
+	if (sketch != nullptr)scheduler.Start(*sketch, loader, settings);
+	else scheduler.Start(*m_concurentSet, loader, settings);
 
 	//Join threads
 	scheduler.Synchronize();
+	return scheduler.GetStatistics();
 }
 
 void Pipeline::OnExit()
 {
+	if (m_partial)
+	{
+		*m_log << "PARTIAL RESULT - stopped by signal after " << m_progress->GetBytes() << " of " << m_totalBytes << " bytes\n";
+	}
+	if (m_unreadBytes != 0)
+	{
+		std::cerr << "INCOMPLETE RESULT - failed to read " << m_unreadBytes << " of " << m_totalBytes << " bytes" << std::endl;
+	}
+	// Shard and export hold only part of the input either way
+	const bool incomplete = m_partial || m_unreadBytes != 0;
+
+	if (m_sketch)
+	{
+		if (m_compareSketch)
+		{
+			m_comparison = MinHashSketch::Compare(*m_sketch, *m_compareSketch);
+			m_distinct = m_comparison.GetUnion();
+			PrintComparison(*m_log, m_comparison, true);
+		}
+		else
+		{
+			m_distinct = (std::uint64_t)(m_sketch->GetCardinality() + 0.5);
+			*m_log << "Estimated number of distinct words: " << m_distinct;
+		}
+
+		const std::size_t memoryUsage = m_sketch->GetMemoryUsage() + (m_compareSketch ? m_compareSketch->GetMemoryUsage() : 0);
+		*m_log << "\nMemory usage of sketches: " << (double)memoryUsage / 1024.0 << " KB";
+		return;
+	}
+
 	//Accumulate results from blocks
-	std::cout << "Number of distinct words: " << m_concurentSet->GetSize();
+	const std::size_t distinct = m_concurentSet->GetSize();
+	if (m_compareLoader)
+	{
+		m_comparison = CompareTaggedHashes(*m_concurentSet);
+		m_distinct = m_comparison.GetUnion();
+		PrintComparison(*m_log, m_comparison, false);
+	}
+	else
+	{
+		m_distinct = distinct;
+		*m_log << "Number of distinct words: " << distinct;
+	}
+
+	const std::size_t memoryUsage = m_concurentSet->GetMemoryUsage();
+	const std::size_t wordsMemory = m_settings.m_keepWords ? m_concurentSet->GetWordsMemoryUsage() : 0;
+	*m_log << "\nMemory usage of distinct set: " << (double)memoryUsage / (1024.0 * 1024.0) << " MB";
+	if (wordsMemory != 0)
+	{
+		*m_log << " (hashes " << (double)(memoryUsage - wordsMemory) / (1024.0 * 1024.0) << " MB, words kept for export "
+			<< (double)wordsMemory / (1024.0 * 1024.0) << " MB)";
+	}
+	if (m_maxMemory != 0 && memoryUsage > m_maxMemory)
+	{
+		// Budget is a soft target, compacted runs and kept words are not limited, only splitting the work can help
+		std::cerr << "\nMemory target of " << m_maxMemory / (1024 * 1024) << " MB exceeded, hashes use "
+			<< (double)(memoryUsage - wordsMemory) / (1024.0 * 1024.0) << " MB";
+		if (wordsMemory != 0)std::cerr << " and words kept for export " << (double)wordsMemory / (1024.0 * 1024.0) << " MB";
+		std::cerr << ", consider hash partitions (-p)" << std::endl;
+	}
+
+	if (m_statistics.m_filterLookups != 0)
+	{
+		*m_log << "\nDuplicate filter hit rate: "
+			<< 100.0 * (double)m_statistics.m_filterHits / (double)m_statistics.m_filterLookups << "% ("
+			<< m_statistics.m_filterHits << " of " << m_statistics.m_filterLookups << " words)";
+	}
+
+	if (!m_outputPath.empty())
+	{
+		std::vector<std::uint64_t> hashes;
+		hashes.reserve(distinct);
+		m_concurentSet->ForEachHash([&hashes](const std::uint64_t hash) {
+			hashes.push_back(hash);
+		});
+
+		ShardSettings settings;
+		settings.m_ngram = (std::uint32_t)m_settings.m_ngram;
+		settings.m_separators = (std::uint32_t)m_settings.m_separatorMode;
+		settings.m_field = (std::uint32_t)m_settings.m_field;
+		settings.m_partition = (std::uint32_t)m_settings.m_partition;
+		settings.m_partitions = (std::uint32_t)m_settings.m_partitions;
+		settings.m_partial = incomplete;
+
+		if (WriteShardFile(m_outputPath, hashes, settings))*m_log << "\nShard written to " << m_outputPath << (incomplete ? " (partial)" : "");
+		else std::cerr << "\nCannot write shard file " << m_outputPath << std::endl;
+	}
+
+	if (!m_exportPath.empty())
+	{
+		const auto start = std::chrono::steady_clock::now();
+		// Both inputs share the set, word of both is kept once per membership tag
+		const std::uint64_t exportIgnoredBits = m_compareLoader ? MEMBERSHIP_MASK : 0;
+
+		std::size_t written = 0;
+		if (m_exportPath == "-")
+		{
+			written = ExportSortedWords(*m_concurentSet, std::cout, m_settings.m_threads, exportIgnoredBits);
+		}
+		else
+		{
+			std::ofstream output(m_exportPath, std::ios::binary);
+			if (!output.good())
+			{
+				std::cerr << "\nCannot write export file " << m_exportPath << std::endl;
+				return;
+			}
+			written = ExportSortedWords(*m_concurentSet, output, m_settings.m_threads, exportIgnoredBits);
+		}
+
+		m_exported = written;
+		const std::chrono::duration<double> exportTime = std::chrono::steady_clock::now() - start;
+		*m_log << "\nExported " << written << " words to " << (m_exportPath == "-" ? "standard output" : m_exportPath) << (incomplete ? " (partial)" : "")
+			<< "\nExport time: " << exportTime.count() << "s";
+	}
+}
+
+bool Pipeline::IsPartial() const
+{
+	return m_partial;
+}
+
+std::uint64_t Pipeline::GetUnreadBytes() const
+{
+	return m_unreadBytes;
+}
+
+std::uint64_t Pipeline::GetNumberOfDistinctWords() const
+{
+	return m_distinct;
+}
+
+SetComparison Pipeline::GetComparison() const
+{
+	return m_comparison;
+}
+
+std::size_t Pipeline::GetNumberOfExportedWords() const
+{
+	return m_exported;
 }
\ No newline at end of file
@@ -3,10 +3,15 @@
 
 #include <unordered_map>
 #include <memory>
+#include <ostream>
+#include <chrono>
 
 #include "../argument-parser/argument-parser.h"
 #include "../file-loader/file-loader.h"
 #include "../concurent-set/concurent-set.h"
+#include "../thread-scheduler/thread-scheduler.h"
+#include "../min-hash/min-hash.h"
+#include "../progress/progress.h"
 
 class Pipeline
 {
@@ -14,11 +19,55 @@ public:
 	bool OnInit(const std::unordered_map<ArgumentType, std::string>& args);
 	void Run();
 	void OnExit();
+
+	/*
+		True when counting was stopped by signal before all chunks were processed
+	*/
+	bool IsPartial() const;
+
+	/*
+		Bytes of input which could not be read and are missing from the result
+	*/
+	std::uint64_t GetUnreadBytes() const;
+
+	/*
+		Results printed by OnExit, estimates in sketch mode.
+		With --compare number of distinct words is the size of union.
+	*/
+	std::uint64_t GetNumberOfDistinctWords() const;
+	SetComparison GetComparison() const;
+	std::size_t GetNumberOfExportedWords() const;
 private:
+	/*
+		Counts words of loader into sketch or, when sketch is nullptr, into the shared set
+		with hashes tagged by membershipTag
+	*/
+	WorkerStatistics Count(FileLoader& loader, MinHashSketch* sketch, const std::uint64_t membershipTag);
+
 	std::unordered_map<ArgumentType, std::string> m_inputArguments;
 	std::unique_ptr<FileLoader> m_loader;
-	std::unique_ptr<ConcurentSet<std::string>> m_concurentSet;
-	std::size_t m_numberOfBlocks;
+	std::unique_ptr<ConcurentSet<std::string_view>> m_concurentSet;
+	// Second input of --compare
+	std::unique_ptr<FileLoader> m_compareLoader;
+	// Sketch mode replaces the set with one sketch per input
+	std::unique_ptr<MinHashSketch> m_sketch;
+	std::unique_ptr<MinHashSketch> m_compareSketch;
+	WorkerSettings m_settings;
+	std::string m_outputPath;
+	std::string m_exportPath;
+	// Informational output, standard error when words are exported to standard output
+	std::ostream* m_log;
+	std::size_t m_maxMemory;
+	WorkerStatistics m_statistics;
+	std::unique_ptr<ProgressCounters> m_progress;
+	// 0 disables periodic reports, counters are published regardless
+	std::chrono::milliseconds m_progressInterval;
+	std::uint64_t m_totalBytes;
+	bool m_partial;
+	std::uint64_t m_unreadBytes;
+	std::uint64_t m_distinct;
+	SetComparison m_comparison;
+	std::size_t m_exported;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "progress.h"
+#include <csignal>
+#include <algorithm>
+
+static std::atomic<bool> g_stopRequested = false;
+static_assert(std::atomic<bool>::is_always_lock_free, "stop flag is set from signal handler");
+
+static void StopHandler(int signal)
+{
+	g_stopRequested.store(true, std::memory_order_relaxed);
+	std::signal(signal, SIG_DFL);
+}
+
+void InstallStopHandler()
+{
+	std::signal(SIGINT, StopHandler);
+	std::signal(SIGTERM, StopHandler);
+}
+
+void RequestStop()
+{
+	g_stopRequested.store(true, std::memory_order_relaxed);
+}
+
+bool StopRequested()
+{
+	return g_stopRequested.load(std::memory_order_relaxed);
+}
+
+void ResetStop()
+{
+	g_stopRequested.store(false, std::memory_order_relaxed);
+}
+
+/*
+* ProgressCounters
+*/
+ProgressCounters::ProgressCounters(const std::size_t& workers)
+	: m_workers(std::max<std::size_t>(workers, 1))
+{
+}
+
+WorkerProgress& ProgressCounters::GetWorker(const std::size_t& worker)
+{
+	return m_workers[worker];
+}
+
+std::uint64_t ProgressCounters::GetBytes() const
+{
+	std::uint64_t bytes = 0;
+	for (const auto& worker : m_workers)
+	{
+		bytes += worker.m_bytes.load(std::memory_order_relaxed);
+	}
+
+	return bytes;
+}
+
+std::uint64_t ProgressCounters::GetWords() const
+{
+	std::uint64_t words = 0;
+	for (const auto& worker : m_workers)
+	{
+		words += worker.m_words.load(std::memory_order_relaxed);
+	}
+
+	return words;
+}
+
+/*
+* ProgressReporter
+*/
+ProgressReporter::~ProgressReporter()
+{
+	Stop();
+}
+
+void ProgressReporter::Start(const ProgressCounters& counters, const std::uint64_t totalBytes, const std::chrono::milliseconds interval, std::ostream& log,
+	std::function<std::uint64_t()> distinct, std::function<std::size_t()> memory)
+{
+	Stop();
+	m_stopping = false;
+
+	m_thread = std::thread([this, &counters, totalBytes, interval, &log, distinct = std::move(distinct), memory = std::move(memory)]() {
+		const auto start = std::chrono::steady_clock::now();
+
+		std::unique_lock lock(m_mutex);
+		while (!m_wakeUp.wait_for(lock, interval, [this]() { return m_stopping; }))
+		{
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			Report(counters, totalBytes, elapsed.count(), log, distinct, memory);
+		}
+	});
+}
+
+void ProgressReporter::Stop()
+{
+	if (!m_thread.joinable())return;
+
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wakeUp.notify_one();
+	m_thread.join();
+}
+
+void ProgressReporter::Report(const ProgressCounters& counters, const std::uint64_t totalBytes, const double seconds, std::ostream& log,
+	const std::function<std::uint64_t()>& distinct, const std::function<std::size_t()>& memory) const
+{
+	const std::uint64_t bytes = counters.GetBytes();
+	const double megabytes = (double)bytes / (1024.0 * 1024.0);
+	const double throughput = seconds > 0.0 ? megabytes / seconds : 0.0;
+
+	log << "Progress: " << (totalBytes != 0 ? 100.0 * (double)bytes / (double)totalBytes : 100.0) << "%, "
+		<< megabytes << " MB at " << throughput << " MB/s, "
+		<< counters.GetWords() << " words, ~" << distinct() << " distinct, "
+		<< (double)memory() / (1024.0 * 1024.0) << " MB memory";
+
+	if (bytes != 0 && bytes < totalBytes)
+	{
+		log << ", ETA " << seconds * (double)(totalBytes - bytes) / (double)bytes << "s";
+	}
+	log << std::endl;
+}
@@ -0,0 +1,86 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+/*
+	Counters of a single worker, published once per chunk.
+	Every worker owns its cache line, so publishing never contends.
+*/
+struct alignas(64) WorkerProgress
+{
+	std::atomic<std::uint64_t> m_bytes = 0;
+	std::atomic<std::uint64_t> m_words = 0;
+};
+
+/*
+	Lock-free progress of all workers, read by ProgressReporter
+	and after counting to detect partial results
+*/
+class ProgressCounters
+{
+public:
+	explicit ProgressCounters(const std::size_t& workers);
+
+	WorkerProgress& GetWorker(const std::size_t& worker);
+
+	std::uint64_t GetBytes() const;
+	std::uint64_t GetWords() const;
+
+private:
+	std::vector<WorkerProgress> m_workers;
+};
+
+/*
+	Thread printing throughput, ETA, distinct estimate and memory every interval.
+	Sleeps on condition variable, so Stop returns immediately.
+*/
+class ProgressReporter
+{
+public:
+	ProgressReporter() = default;
+	~ProgressReporter();
+
+	ProgressReporter(const ProgressReporter& other) = delete;
+	ProgressReporter& operator=(const ProgressReporter& other) = delete;
+
+	/*
+		distinct and memory are sampled once per report from the reporter thread
+	*/
+	void Start(const ProgressCounters& counters, const std::uint64_t totalBytes, const std::chrono::milliseconds interval, std::ostream& log,
+		std::function<std::uint64_t()> distinct, std::function<std::size_t()> memory);
+	void Stop();
+
+private:
+	void Report(const ProgressCounters& counters, const std::uint64_t totalBytes, const double seconds, std::ostream& log,
+		const std::function<std::uint64_t()>& distinct, const std::function<std::size_t()>& memory) const;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	bool m_stopping = false;
+};
+
+/*
+	Installs SIGINT and SIGTERM handler which requests cooperative stop:
+	workers finish their current chunk and claim no more.
+	The handler restores default action, so a second signal terminates the process.
+*/
+void InstallStopHandler();
+void RequestStop();
+bool StopRequested();
+
+/*
+	Clears requested stop, lets the next pipeline in the same process run to the end
+*/
+void ResetStop();
+
+#endif
@@ -0,0 +1,24 @@
+#include "set-comparison.h"
+
+std::uint64_t SetComparison::GetUnion() const
+{
+	return m_first + m_second - m_intersection;
+}
+
+std::uint64_t SetComparison::GetFirstOnly() const
+{
+	return m_first - m_intersection;
+}
+
+std::uint64_t SetComparison::GetSecondOnly() const
+{
+	return m_second - m_intersection;
+}
+
+double SetComparison::GetJaccard() const
+{
+	const std::uint64_t sum = GetUnion();
+	if (sum == 0)return 0.0;
+
+	return (double)m_intersection / (double)sum;
+}
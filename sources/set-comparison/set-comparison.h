@@ -0,0 +1,70 @@
+#ifndef SET_COMPARISON_H
+#define SET_COMPARISON_H
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+/*
+	Comparing two inputs in one shared set: low bits of every inserted hash
+	are replaced with membership tag of its input, so a word present in both
+	inputs is stored once with each tag. WyHashPolicy selects bucket
+	from the high 32 bits, so both copies share a bucket.
+*/
+constexpr std::uint64_t MEMBERSHIP_MASK = 3;
+constexpr std::uint64_t FIRST_INPUT = 1;
+constexpr std::uint64_t SECOND_INPUT = 2;
+
+inline std::uint64_t TagMembership(const std::uint64_t hash, const std::uint64_t tag)
+{
+	return (hash & ~MEMBERSHIP_MASK) | tag;
+}
+
+/*
+	Sizes of two word sets and of their intersection, exact or estimated
+*/
+struct SetComparison
+{
+	std::uint64_t m_first = 0;
+	std::uint64_t m_second = 0;
+	std::uint64_t m_intersection = 0;
+
+	std::uint64_t GetUnion() const;
+	std::uint64_t GetFirstOnly() const;
+	std::uint64_t GetSecondOnly() const;
+	double GetJaccard() const;
+};
+
+/*
+	Counts exact comparison of hashes tagged with TagMembership,
+	set has to provide ForEachHash and GetSize (e.g. ConcurentSet)
+*/
+template<class Set>
+SetComparison CompareTaggedHashes(const Set& set);
+
+template<class Set>
+inline SetComparison CompareTaggedHashes(const Set& set)
+{
+	std::vector<std::uint64_t> hashes;
+	hashes.reserve(set.GetSize());
+	set.ForEachHash([&hashes](const std::uint64_t hash) {
+		hashes.push_back(hash);
+	});
+
+	// Both tags of a word differ only in tag bits, so they become neighbours
+	std::sort(hashes.begin(), hashes.end());
+
+	SetComparison comparison;
+	for (std::size_t i = 0; i < hashes.size(); ++i)
+	{
+		const std::uint64_t tag = hashes[i] & MEMBERSHIP_MASK;
+		if (tag == FIRST_INPUT)comparison.m_first++;
+		else if (tag == SECOND_INPUT)comparison.m_second++;
+
+		if (i != 0 && (hashes[i] & ~MEMBERSHIP_MASK) == (hashes[i - 1] & ~MEMBERSHIP_MASK))comparison.m_intersection++;
+	}
+
+	return comparison;
+}
+
+#endif
@@ -0,0 +1,289 @@
+#include "shard-file.h"
+#include "../varint/varint.h"
+#include <algorithm>
+#include <queue>
+#include <iostream>
+#include <memory>
+
+static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+static void StoreLittleEndian(char* destination, std::uint64_t value, const std::size_t bytes)
+{
+	for (std::size_t i = 0; i < bytes; ++i)
+	{
+		destination[i] = (char)(value & 0xff);
+		value >>= 8;
+	}
+}
+
+static std::uint64_t LoadLittleEndian(const char* source, const std::size_t bytes)
+{
+	std::uint64_t value = 0;
+	for (std::size_t i = 0; i < bytes; ++i)
+	{
+		value |= (std::uint64_t)(unsigned char)source[i] << (8 * i);
+	}
+	return value;
+}
+
+bool ShardSettings::IsCompatible(const ShardSettings& other) const
+{
+	return m_ngram == other.m_ngram && m_separators == other.m_separators && m_field == other.m_field && m_partitions == other.m_partitions;
+}
+
+/*
+* ShardWriter
+*/
+ShardWriter::ShardWriter(const std::filesystem::path& path, const ShardSettings& settings)
+	: m_path(path), m_temporaryPath(path.string() + ".tmp"), m_settings(settings), m_file(m_temporaryPath, std::ios::binary | std::ios::trunc)
+{
+	m_previous = 0;
+	m_count = 0;
+	m_payloadSize = 0;
+	m_closed = false;
+	m_buffer.reserve(BUFFER_SIZE);
+
+	// Header is rewritten with final counts in Close
+	const char emptyHeader[SHARD_FILE_HEADER_SIZE] = {};
+	m_file.write(emptyHeader, SHARD_FILE_HEADER_SIZE);
+}
+
+ShardWriter::~ShardWriter()
+{
+	// Temporary file which could not be opened was not created by this writer
+	if (m_closed || !m_file.is_open())return;
+
+	// Never completed, the empty header would be rejected anyway
+	m_file.close();
+	std::error_code error;
+	std::filesystem::remove(m_temporaryPath, error);
+}
+
+bool ShardWriter::Good() const
+{
+	return m_file.good();
+}
+
+void ShardWriter::Append(const std::uint64_t hash)
+{
+	if (m_count != 0 && hash <= m_previous)return;
+
+	AppendVarint(m_buffer, hash - m_previous);
+
+	m_previous = hash;
+	m_count++;
+
+	if (m_buffer.size() >= BUFFER_SIZE)Flush();
+}
+
+bool ShardWriter::Close()
+{
+	if (m_closed)return m_file.good();
+	m_closed = true;
+	if (!m_file.is_open())return false;
+
+	Flush();
+
+	char header[SHARD_FILE_HEADER_SIZE] = {};
+	std::copy(std::begin(SHARD_FILE_MAGIC), std::end(SHARD_FILE_MAGIC), header);
+	StoreLittleEndian(header + 8, SHARD_FILE_VERSION, 4);
+	StoreLittleEndian(header + 12, m_settings.m_partial ? SHARD_FLAG_PARTIAL : 0, 4);
+	StoreLittleEndian(header + 16, m_count, 8);
+	StoreLittleEndian(header + 24, m_payloadSize, 8);
+	StoreLittleEndian(header + 32, m_settings.m_ngram, 4);
+	StoreLittleEndian(header + 36, m_settings.m_separators, 4);
+	StoreLittleEndian(header + 40, m_settings.m_field, 4);
+	StoreLittleEndian(header + 44, m_settings.m_partition, 4);
+	StoreLittleEndian(header + 48, m_settings.m_partitions, 4);
+
+	m_file.seekp(0);
+	m_file.write(header, SHARD_FILE_HEADER_SIZE);
+	m_file.close();
+
+	std::error_code error;
+	if (!m_file.fail())std::filesystem::rename(m_temporaryPath, m_path, error);
+	if (m_file.fail() || error)
+	{
+		std::filesystem::remove(m_temporaryPath, error);
+		return false;
+	}
+	return true;
+}
+
+std::uint64_t ShardWriter::GetCount() const
+{
+	return m_count;
+}
+
+void ShardWriter::Flush()
+{
+	m_file.write(m_buffer.data(), m_buffer.size());
+	m_payloadSize += m_buffer.size();
+	m_buffer.clear();
+}
+
+/*
+* ShardReader
+*/
+ShardReader::ShardReader(const std::filesystem::path& path) : m_file(path, std::ios::binary)
+{
+	m_position = 0;
+	m_available = 0;
+	m_previous = 0;
+	m_count = 0;
+	m_read = 0;
+	m_good = false;
+
+	char header[SHARD_FILE_HEADER_SIZE] = {};
+	if (!m_file.read(header, SHARD_FILE_HEADER_SIZE))return;
+	if (!std::equal(std::begin(SHARD_FILE_MAGIC), std::end(SHARD_FILE_MAGIC), header))return;
+	if (LoadLittleEndian(header + 8, 4) != SHARD_FILE_VERSION)return;
+
+	m_settings.m_partial = (LoadLittleEndian(header + 12, 4) & SHARD_FLAG_PARTIAL) != 0;
+	m_count = LoadLittleEndian(header + 16, 8);
+	m_settings.m_ngram = (std::uint32_t)LoadLittleEndian(header + 32, 4);
+	m_settings.m_separators = (std::uint32_t)LoadLittleEndian(header + 36, 4);
+	m_settings.m_field = (std::uint32_t)LoadLittleEndian(header + 40, 4);
+	m_settings.m_partition = (std::uint32_t)LoadLittleEndian(header + 44, 4);
+	m_settings.m_partitions = (std::uint32_t)LoadLittleEndian(header + 48, 4);
+	m_buffer.resize(BUFFER_SIZE);
+	m_good = true;
+}
+
+bool ShardReader::Good() const
+{
+	return m_good;
+}
+
+bool ShardReader::Next(std::uint64_t& hash)
+{
+	if (!m_good || m_read == m_count)return false;
+
+	std::uint64_t delta = 0;
+	if (!ReadVarint([this](unsigned char& byte) { return ReadByte(byte); }, delta))
+	{
+		m_good = false;
+		return false;
+	}
+
+	m_previous += delta;
+	m_read++;
+	hash = m_previous;
+
+	return true;
+}
+
+std::uint64_t ShardReader::GetCount() const
+{
+	return m_count;
+}
+
+ShardSettings ShardReader::GetSettings() const
+{
+	return m_settings;
+}
+
+bool ShardReader::ReadByte(unsigned char& byte)
+{
+	if (m_position == m_available)
+	{
+		m_file.read(m_buffer.data(), m_buffer.size());
+		m_available = (std::size_t)m_file.gcount();
+		m_position = 0;
+		if (m_available == 0)return false;
+	}
+
+	byte = (unsigned char)m_buffer[m_position++];
+	return true;
+}
+
+bool WriteShardFile(const std::filesystem::path& path, std::vector<std::uint64_t>& hashes, const ShardSettings& settings)
+{
+	std::sort(hashes.begin(), hashes.end());
+
+	ShardWriter writer(path, settings);
+	if (!writer.Good())return false;
+
+	for (const std::uint64_t hash : hashes)
+	{
+		writer.Append(hash);
+	}
+
+	return writer.Close();
+}
+
+bool MergeShardFiles(const std::vector<std::filesystem::path>& inputs, const std::filesystem::path& output, std::uint64_t& distinct)
+{
+	std::vector<std::unique_ptr<ShardReader>> readers;
+	ShardSettings settings;
+	for (const auto& input : inputs)
+	{
+		readers.push_back(std::make_unique<ShardReader>(input));
+		if (!readers.back()->Good())
+		{
+			std::cerr << "Cannot read shard file " << input << std::endl;
+			return false;
+		}
+
+		const ShardSettings inputSettings = readers.back()->GetSettings();
+		if (inputSettings.m_partial)
+		{
+			std::cerr << "Warning: shard file " << input << " holds a partial result, so does the merged one" << std::endl;
+		}
+
+		if (readers.size() == 1)
+		{
+			settings = inputSettings;
+		}
+		else if (!settings.IsCompatible(inputSettings))
+		{
+			std::cerr << "Shard file " << input << " was counted with different -n, -s, -k or number of partitions" << std::endl;
+			return false;
+		}
+		else if (settings.m_partition != inputSettings.m_partition)
+		{
+			settings.m_partition = SHARD_MIXED_PARTITION;
+		}
+		settings.m_partial = settings.m_partial || inputSettings.m_partial;
+	}
+
+	ShardWriter writer(output, settings);
+	if (!writer.Good())
+	{
+		std::cerr << "Cannot write shard file " << output << std::endl;
+		return false;
+	}
+
+	// Min-heap of (current hash, reader index)
+	using HeapEntry = std::pair<std::uint64_t, std::size_t>;
+	std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+
+	std::uint64_t hash = 0;
+	for (std::size_t i = 0; i < readers.size(); ++i)
+	{
+		if (readers[i]->Next(hash))heap.emplace(hash, i);
+	}
+
+	while (!heap.empty())
+	{
+		const auto [smallest, reader] = heap.top();
+		heap.pop();
+
+		writer.Append(smallest);
+		if (readers[reader]->Next(hash))heap.emplace(hash, reader);
+	}
+
+	for (std::size_t i = 0; i < readers.size(); ++i)
+	{
+		if (!readers[i]->Good())
+		{
+			std::cerr << "Shard file " << inputs[i] << " is corrupted" << std::endl;
+			return false;
+		}
+	}
+
+	// Inputs are closed first, output may replace one of them
+	readers.clear();
+	distinct = writer.GetCount();
+	return writer.Close();
+}
@@ -0,0 +1,147 @@
+#ifndef SHARD_FILE_H
+#define SHARD_FILE_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+/*
+	Distinct set serialized as sorted hashes, version 2 layout:
+
+	offset  size  field
+	0       8     magic "UWSHARD\0"
+	8       4     version
+	12      4     flags, SHARD_FLAG_PARTIAL
+	16      8     number of hashes
+	24      8     payload size in bytes
+	32      4     n-gram length (-n)
+	36      4     separators, SeparatorMode value (-s)
+	40      4     zero based column (-k)
+	44      4     partition index (-p), SHARD_MIXED_PARTITION after merging different ones
+	48      4     number of partitions (-p)
+	52      12    reserved, 0
+	64      ...   payload - LEB128 varints, difference of every hash to the previous one
+	              (first one to 0)
+
+	All fixed fields are little-endian, so the file can be mapped and
+	the payload scanned in place.
+	Header is written last, a file without valid header was not completed.
+*/
+constexpr char SHARD_FILE_MAGIC[8] = { 'U', 'W', 'S', 'H', 'A', 'R', 'D', '\0' };
+constexpr std::uint32_t SHARD_FILE_VERSION = 2;
+constexpr std::size_t SHARD_FILE_HEADER_SIZE = 64;
+constexpr std::uint32_t SHARD_MIXED_PARTITION = 0xffffffff;
+// Counting was stopped or could not read the whole input
+constexpr std::uint32_t SHARD_FLAG_PARTIAL = 1;
+
+/*
+	Tokenizer settings which produced the hashes, hashes of shards
+	with different settings are not comparable
+*/
+struct ShardSettings
+{
+	std::uint32_t m_ngram = 1;
+	std::uint32_t m_separators = 0;
+	std::uint32_t m_field = 0;
+	std::uint32_t m_partition = 0;
+	std::uint32_t m_partitions = 1;
+	// Hashes of only part of the input, SHARD_FLAG_PARTIAL
+	bool m_partial = false;
+
+	/*
+		Same tokenization and partitioning scheme, partition index and partial flag may differ
+	*/
+	bool IsCompatible(const ShardSettings& other) const;
+};
+
+/*
+	Streams strictly increasing hashes into shard file,
+	repeated hashes are skipped.
+	Hashes are written to path + ".tmp" which replaces path only after successful Close,
+	so path may be one of the shards being read and failed writes never touch it.
+	Writer destroyed without successful Close removes its temporary file.
+*/
+class ShardWriter
+{
+public:
+	ShardWriter(const std::filesystem::path& path, const ShardSettings& settings);
+	~ShardWriter();
+
+	ShardWriter(const ShardWriter& other) = delete;
+	ShardWriter& operator=(const ShardWriter& other) = delete;
+
+	bool Good() const;
+	void Append(const std::uint64_t hash);
+
+	/*
+		Flushes payload and writes final header
+	*/
+	bool Close();
+
+	std::uint64_t GetCount() const;
+
+private:
+	void Flush();
+
+	std::filesystem::path m_path;
+	std::filesystem::path m_temporaryPath;
+	ShardSettings m_settings;
+	std::ofstream m_file;
+	std::vector<char> m_buffer;
+	std::uint64_t m_previous;
+	std::uint64_t m_count;
+	std::uint64_t m_payloadSize;
+	bool m_closed;
+};
+
+/*
+	Reads hashes from shard file in increasing order using fixed size buffer
+*/
+class ShardReader
+{
+public:
+	explicit ShardReader(const std::filesystem::path& path);
+
+	ShardReader(const ShardReader& other) = delete;
+	ShardReader& operator=(const ShardReader& other) = delete;
+
+	/*
+		False when file is missing, has wrong magic or unsupported version
+	*/
+	bool Good() const;
+	bool Next(std::uint64_t& hash);
+
+	std::uint64_t GetCount() const;
+	ShardSettings GetSettings() const;
+
+private:
+	bool ReadByte(unsigned char& byte);
+
+	std::ifstream m_file;
+	std::vector<char> m_buffer;
+	std::size_t m_position;
+	std::size_t m_available;
+	std::uint64_t m_previous;
+	std::uint64_t m_count;
+	std::uint64_t m_read;
+	ShardSettings m_settings;
+	bool m_good;
+};
+
+/*
+	Sorts hashes and writes them as shard file
+*/
+bool WriteShardFile(const std::filesystem::path& path, std::vector<std::uint64_t>& hashes, const ShardSettings& settings);
+
+/*
+	k-way streaming merge of shard files, memory use does not depend on their sizes.
+	Inputs have to have compatible settings. Output may be one of the inputs,
+	it is replaced only when the merge succeeds.
+	Partial inputs are reported and make the output partial too.
+	distinct receives number of hashes in the output.
+*/
+bool MergeShardFiles(const std::vector<std::filesystem::path>& inputs, const std::filesystem::path& output, std::uint64_t& distinct);
+
+#endif
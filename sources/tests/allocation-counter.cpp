@@ -0,0 +1,55 @@
+#include "allocation-counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<bool> g_countAllocations = false;
+static std::atomic<std::size_t> g_allocations = 0;
+
+#ifdef COUNT_ALLOCATIONS
+/*
+	Kept in its own translation unit, so callers never see malloc/free
+	paired with new/delete expressions
+*/
+void* operator new(std::size_t size)
+{
+	if (g_countAllocations.load(std::memory_order_relaxed))
+	{
+		g_allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (void* ptr = std::malloc(size == 0 ? 1 : size))return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+#endif
+
+bool AllocationCountingEnabled()
+{
+#ifdef COUNT_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void StartCountingAllocations()
+{
+	g_allocations = 0;
+	g_countAllocations = true;
+}
+
+std::size_t StopCountingAllocations()
+{
+	g_countAllocations = false;
+	return g_allocations;
+}
@@ -0,0 +1,15 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+/*
+	Counts calls of global operator new between Start and Stop.
+	Replacement operators are compiled only with COUNT_ALLOCATIONS defined
+	(Debug configuration), other builds keep the default allocator untouched.
+*/
+bool AllocationCountingEnabled();
+void StartCountingAllocations();
+std::size_t StopCountingAllocations();
+
+#endif
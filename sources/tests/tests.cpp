@@ -2,11 +2,82 @@
 #include <chrono>
 #include <unordered_set>
 #include <fstream>
+#include <vector>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+#include <deque>
+#include <algorithm>
+#include <iterator>
+#include <limits>
 
 #include "../trie/trie.h"
+#include "../hash/hash.h"
+#include "../tokenizer/tokenizer.h"
 #include "../pipeline/pipeline.h"
+#include "../delta-encoding/delta-encoding.h"
+#include "../word-export/word-export.h"
+#include "../shard-file/shard-file.h"
+#include "allocation-counter.h"
 
-void Test(std::unordered_map<ArgumentType, std::string> args)
+using Arguments = std::unordered_map<ArgumentType, std::string>;
+
+static std::size_t g_failedChecks = 0;
+
+/*
+	Prints result of a single check, failed checks make Test return false
+*/
+static void Check(const bool condition, const std::string& description)
+{
+	std::cout << (condition ? "\tPASSED: " : "\tFAILED: ") << description << "\n";
+	if (!condition)g_failedChecks++;
+}
+
+static Arguments WithArguments(Arguments args, std::initializer_list<std::pair<const ArgumentType, std::string>> overrides)
+{
+	for (const auto& [type, value] : overrides)
+	{
+		args[type] = value;
+	}
+	return args;
+}
+
+static std::vector<std::string> ReadLines(const std::string& name)
+{
+	std::ifstream file(name, std::ios::binary);
+	std::vector<std::string> lines;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+/*
+	Runs whole Pipeline, prints its results and counting time,
+	countingTime receives the time when given
+*/
+static bool RunPipeline(const std::string& title, const Arguments& args, Pipeline& task, double* countingTime = nullptr)
+{
+	std::cout << "\n\n--- " << title << " --- \n";
+	auto start = std::chrono::system_clock::now();
+	if (!task.OnInit(args))
+	{
+		Check(false, title + " accepts its arguments");
+		return false;
+	}
+	task.Run();
+	auto end = std::chrono::system_clock::now();
+
+	task.OnExit();
+	const double seconds = std::chrono::duration<double>(end - start).count();
+	std::cout << "\nTime:\t\t" << seconds << "s" << std::endl;
+	if (countingTime != nullptr)*countingTime = seconds;
+	return true;
+}
+
+bool Test(Arguments args)
 {
 	constexpr std::size_t testSize = 10 * (1024 * 1024); //
 	std::string fileName = "test_" + std::to_string(testSize) + ".txt";
@@ -24,17 +95,157 @@ void Test(std::unordered_map<ArgumentType, std::string> args)
 		fileName = args.at(ArgumentType::FILE_NAME);
 		std::cout << "Using " << fileName << " test file \n";
 	}
+	g_failedChecks = 0;
+
+	{
+		std::cout << "\n\n--- Hash policies --- \n";
+		TestHashPolicies(fileName);
+	}
+
+	{
+		std::cout << "\n\n--- Allocations --- \n";
+		TestAllocations(fileName);
+	}
+
+	{
+		std::cout << "\n\n--- Components --- \n";
+		TestDeltaEncoding();
+		TestRadixSort();
+		TestLoadChunk();
+		TestCsvQuoting();
+		TestShardFiles();
+	}
+
+	{
+		std::cout << "\n\n--- Csv n-grams at different chunk sizes --- \n";
+		TestCsvNGrams(args);
+	}
+
+	// Reference counts of every mode
+	const std::size_t distinctWords = GetUniqueWordsSTD(fileName);
+	const std::size_t distinctTrigrams = GetUniqueNGramsSTD(fileName, 3);
 
 	{
-		std::cout << "\n\n--- Concurent set --- \n";
-		auto start = std::chrono::system_clock::now();
 		Pipeline task;
-		if (!task.OnInit(args))return;
-		task.Run();
-		auto end = std::chrono::system_clock::now();
+		if (RunPipeline("Concurent set", args, task))
+		{
+			Check(task.GetNumberOfDistinctWords() == distinctWords, "distinct words equal to std::unordered_set");
+		}
+	}
+
+	{
+		// Counters are published after every chunk either way, reports add only the reporter thread.
+		// Runs alternate and swap order, so both see the same page cache and heap state, best times are compared.
+		constexpr std::size_t repetitions = 5;
+		double plainTime = std::numeric_limits<double>::max(), progressTime = std::numeric_limits<double>::max();
+		bool progressCounted = true;
+		for (std::size_t i = 0; i < 2 * repetitions; ++i)
+		{
+			double seconds = 0.0;
+			Pipeline task;
+			if ((i + i / 2) % 2 == 0)
+			{
+				if (RunPipeline("Concurent set without progress reports", args, task, &seconds))plainTime = std::min(plainTime, seconds);
+			}
+			else if (RunPipeline("Concurent set with progress reports every second", WithArguments(args, { { ArgumentType::PROGRESS, "1" } }), task, &seconds))
+			{
+				progressTime = std::min(progressTime, seconds);
+				progressCounted = progressCounted && task.GetNumberOfDistinctWords() == distinctWords;
+			}
+		}
+		std::cout << "\nProgress reports, best of " << repetitions << ": " << progressTime << "s, without: " << plainTime
+			<< "s, ratio " << progressTime / plainTime << "\n";
+		Check(progressCounted, "distinct words with progress reports equal to std::unordered_set");
+	}
+
+	{
+		// Stop requested before counting, workers claim no chunk
+		const std::string shardName = fileName + ".shard";
+		Pipeline task;
+		RequestStop();
+		const bool counted = RunPipeline("Concurent set stopped before counting", WithArguments(args, { { ArgumentType::OUTPUT, shardName } }), task);
+		ResetStop();
+		if (counted)
+		{
+			Check(task.IsPartial() && task.GetUnreadBytes() == 0, "stopped run is partial, not a read failure");
+			Check(ShardReader(shardName).GetSettings().m_partial, "shard of stopped run is flagged partial");
+		}
+		std::remove(shardName.c_str());
+	}
+
+	{
+		Pipeline task;
+		if (RunPipeline("Concurent set with duplicate filter", WithArguments(args, { { ArgumentType::FILTER_SIZE, "32" } }), task))
+		{
+			Check(task.GetNumberOfDistinctWords() == distinctWords, "distinct words equal to std::unordered_set");
+		}
+	}
+
+	{
+		Pipeline task;
+		if (RunPipeline("Concurent set with 8 MB memory budget", WithArguments(args, { { ArgumentType::MAX_MEMORY, "8" } }), task))
+		{
+			Check(task.GetNumberOfDistinctWords() == distinctWords, "distinct words equal to std::unordered_set");
+		}
+	}
+
+	{
+		Pipeline task;
+		if (RunPipeline("Concurent set, trigrams", WithArguments(args, { { ArgumentType::NGRAM, "3" } }), task))
+		{
+			Check(task.GetNumberOfDistinctWords() == distinctTrigrams, "distinct trigrams equal to std::unordered_set");
+		}
+	}
 
-		task.OnExit();
-		std::cout << "\nTime:\t\t" << std::chrono::duration<double>(end - start).count() << "s" << std::endl;
+	{
+		const std::string exportName = fileName + ".sorted";
+		Pipeline task;
+		if (RunPipeline("Concurent set, sorted export", WithArguments(args, { { ArgumentType::EXPORT, exportName } }), task))
+		{
+			Check(task.GetNumberOfExportedWords() == distinctWords, "number of exported words equal to std::unordered_set");
+			Check(ReadLines(exportName) == GetSortedUniqueWords(fileName), "exported words equal to sorted std::unordered_set");
+		}
+		std::remove(exportName.c_str());
+	}
+
+	{
+		// Budget compacts buckets, so words are kept more than once before export dedups them
+		const std::string exportName = fileName + ".sorted";
+		Pipeline task;
+		if (RunPipeline("Concurent set, sorted trigram export with 8 MB memory budget",
+			WithArguments(args, { { ArgumentType::EXPORT, exportName }, { ArgumentType::NGRAM, "3" }, { ArgumentType::MAX_MEMORY, "8" } }), task))
+		{
+			Check(task.GetNumberOfExportedWords() == task.GetNumberOfDistinctWords(), "number of exported trigrams equal to counted trigrams");
+			Check(ReadLines(exportName) == GetSortedUniqueNGrams(fileName, 3), "exported trigrams equal to sorted std::unordered_set");
+		}
+		std::remove(exportName.c_str());
+	}
+
+	{
+		Pipeline task;
+		const std::string exportName = fileName + ".sorted";
+		if (RunPipeline("Concurent set, comparison with itself and sorted export",
+			WithArguments(args, { { ArgumentType::COMPARE, fileName }, { ArgumentType::EXPORT, exportName } }), task))
+		{
+			const SetComparison comparison = task.GetComparison();
+			Check(comparison.m_first == distinctWords && comparison.m_second == distinctWords && comparison.m_intersection == distinctWords,
+				"both inputs and intersection equal to std::unordered_set");
+			Check(task.GetNumberOfExportedWords() == comparison.GetUnion() && ReadLines(exportName).size() == comparison.GetUnion(),
+				"exported words equal to union, shared words once");
+		}
+		std::remove(exportName.c_str());
+	}
+
+	{
+		Pipeline task;
+		if (RunPipeline("MinHash sketch, comparison with itself",
+			WithArguments(args, { { ArgumentType::COMPARE, fileName }, { ArgumentType::SKETCH, "1024" } }), task))
+		{
+			// Relative standard error of 1024 hashes is about 3%
+			const double error = std::abs((double)task.GetNumberOfDistinctWords() - (double)distinctWords) / (double)distinctWords;
+			Check(error < 0.1, "estimate within 10% of std::unordered_set");
+			Check(task.GetComparison().GetJaccard() == 1.0, "Jaccard similarity of identical inputs is 1");
+		}
 	}
 
 	{
@@ -48,13 +259,386 @@ void Test(std::unordered_map<ArgumentType, std::string> args)
 	{
 		std::cout << "\n\n--- Trie --- \n";
 		auto start = std::chrono::system_clock::now();
-		std::cout << "Number of distinct words: " << GetUniqueWordsTrie(fileName);
+		std::size_t memoryUsage = 0;
+		std::cout << "Number of distinct words: " << GetUniqueWordsTrie(fileName, memoryUsage);
+		std::cout << "\nMemory usage of trie: " << (double)memoryUsage / (1024.0 * 1024.0) << " MB";
 		auto end = std::chrono::system_clock::now();
 		std::cout << "\ntime:\t\t" << std::chrono::duration<double>(end - start).count() << "s" << std::endl;
 	}
+
+	std::cout << "\n" << (g_failedChecks == 0 ? "All checks passed" : std::to_string(g_failedChecks) + " checks FAILED") << std::endl;
+	return g_failedChecks == 0;
 }
 
-std::size_t GetUniqueWordsTrie(const std::string& name)
+void TestDeltaEncoding()
+{
+	DeltaEncodedHashes run;
+	std::vector<std::uint64_t> first = { 0, 5, 127, 128, 1ull << 40, ~0ull };
+	std::vector<std::uint64_t> second = { 1, 5, 128, 300, 1ull << 40, (1ull << 63) + 1 };
+
+	const std::size_t addedFirst = run.Merge(first);
+	const std::size_t addedSecond = run.Merge(second);
+
+	std::vector<std::uint64_t> expected;
+	std::set_union(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(expected));
+	std::vector<std::uint64_t> decoded;
+	run.ForEach([&decoded](const std::uint64_t hash) {
+		decoded.push_back(hash);
+	});
+
+	Check(addedFirst == first.size() && addedSecond == 3, "DeltaEncodedHashes::Merge counts only new hashes");
+	Check(decoded == expected && run.GetSize() == expected.size(), "DeltaEncodedHashes::Merge keeps sorted union");
+
+	// Overlapping batches, as written by a bucket whose words repeat after compaction
+	TieredHashRuns runs;
+	std::vector<std::uint64_t> all;
+	for (std::uint64_t batch = 0; batch < 100; ++batch)
+	{
+		std::vector<std::uint64_t> hashes;
+		for (std::uint64_t i = 0; i < 1000; ++i)
+		{
+			hashes.push_back(WyHashPolicy::Hash(std::to_string(batch * 700 + i)));
+		}
+		std::sort(hashes.begin(), hashes.end());
+		runs.Add(hashes);
+		all.insert(all.end(), hashes.begin(), hashes.end());
+	}
+	std::sort(all.begin(), all.end());
+	all.erase(std::unique(all.begin(), all.end()), all.end());
+
+	std::vector<std::uint64_t> walked;
+	runs.ForEach([&walked](const std::uint64_t hash) {
+		walked.push_back(hash);
+	});
+	Check(walked == all, "TieredHashRuns::ForEach yields distinct hashes of all runs");
+	Check(runs.GetNumberOfRuns() <= 8, "TieredHashRuns keeps logarithmic number of runs");
+}
+
+void TestRadixSort()
+{
+	// Long shared prefixes, empty words and bytes above 0x7f
+	std::vector<std::string> storage = { "", "a", "", "\xff", "\x80" "a", "ab" };
+	for (std::size_t i = 0; i < 2000; ++i)
+	{
+		storage.push_back(std::string(1 + rand() % 300, 'a') + (char)('a' + rand() % 3) + std::to_string(rand() % 50));
+	}
+
+	std::vector<std::string_view> words(storage.begin(), storage.end());
+	std::vector<std::string_view> expected = words;
+	std::sort(expected.begin(), expected.end());
+	RadixSort(words);
+
+	Check(words == expected, "RadixSort orders like std::sort");
+}
+
+static std::vector<std::uint64_t> ReadShardFile(const std::string& name)
+{
+	std::vector<std::uint64_t> hashes;
+	ShardReader reader(name);
+	std::uint64_t hash = 0;
+	while (reader.Next(hash))
+	{
+		hashes.push_back(hash);
+	}
+
+	if (!reader.Good() || hashes.size() != reader.GetCount())hashes.clear();
+	return hashes;
+}
+
+void TestShardFiles()
+{
+	std::vector<std::uint64_t> first, second;
+	for (std::uint64_t i = 0; i < 10000; ++i)
+	{
+		first.push_back(WyHashPolicy::Hash(std::to_string(i)));
+		second.push_back(WyHashPolicy::Hash(std::to_string(i + 5000)));
+	}
+	first.push_back(first.front());
+
+	ShardSettings settings;
+	settings.m_ngram = 2;
+	settings.m_partitions = 4;
+	ShardSettings otherPartition = settings;
+	otherPartition.m_partition = 1;
+
+	Check(WriteShardFile("first.shard", first, settings) && WriteShardFile("second.shard", second, otherPartition), "shard files written");
+
+	std::vector<std::uint64_t> uniqueFirst = first;
+	uniqueFirst.erase(std::unique(uniqueFirst.begin(), uniqueFirst.end()), uniqueFirst.end());
+	Check(ReadShardFile("first.shard") == uniqueFirst, "shard file reads back sorted unique hashes");
+
+	std::uint64_t distinct = 0;
+	std::vector<std::uint64_t> expected;
+	std::set_union(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(expected));
+	expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+	const bool merged = MergeShardFiles({ "first.shard", "second.shard" }, "merged.shard", distinct);
+	Check(merged && distinct == 15000 && ReadShardFile("merged.shard") == expected, "merged shard holds union of inputs");
+	Check(ShardReader("merged.shard").GetSettings().m_partition == SHARD_MIXED_PARTITION, "merged shard records mixed partitions");
+	Check(!ShardReader("merged.shard").GetSettings().m_partial, "merged shard of complete inputs is not partial");
+
+	// Partial input makes the merged shard partial
+	ShardSettings partial = otherPartition;
+	partial.m_partial = true;
+	Check(WriteShardFile("partial.shard", second, partial) && ShardReader("partial.shard").GetSettings().m_partial
+		&& MergeShardFiles({ "first.shard", "partial.shard" }, "merged.shard", distinct) && ShardReader("merged.shard").GetSettings().m_partial,
+		"partial flag is read back and carried into merged shard");
+
+	// Output may be one of the inputs, it is replaced only by a finished merge
+	std::filesystem::copy_file("first.shard", "total.shard", std::filesystem::copy_options::overwrite_existing);
+	Check(MergeShardFiles({ "total.shard", "second.shard" }, "total.shard", distinct) && ReadShardFile("total.shard") == expected
+		&& !std::filesystem::exists("total.shard.tmp"), "merge into one of its inputs keeps the union");
+
+	// Settings of different tokenization are refused
+	ShardSettings trigrams = settings;
+	trigrams.m_ngram = 3;
+	Check(WriteShardFile("trigrams.shard", second, trigrams) && !MergeShardFiles({ "first.shard", "trigrams.shard" }, "refused.shard", distinct)
+		&& !std::filesystem::exists("refused.shard"), "shards of different n-gram length are not merged");
+
+	// Truncated payload fails the merge and leaves no output
+	std::filesystem::resize_file("second.shard", std::filesystem::file_size("second.shard") / 2);
+	Check(!MergeShardFiles({ "first.shard", "second.shard" }, "truncated.shard", distinct) && !std::filesystem::exists("truncated.shard"),
+		"merge of truncated shard fails without output");
+	Check(!MergeShardFiles({ "total.shard", "second.shard" }, "total.shard", distinct) && ReadShardFile("total.shard") == expected,
+		"failed merge into one of its inputs leaves it intact");
+
+	for (const char* name : { "first.shard", "second.shard", "partial.shard", "merged.shard", "trigrams.shard", "total.shard" })
+	{
+		std::remove(name);
+	}
+}
+
+/*
+	Tokens of all chunks together have to be tokens of the whole file,
+	whatever the chunk size
+*/
+template<class SeparatorPolicy>
+static std::vector<std::string> LoadChunks(const std::string& name, const std::size_t& chunkSize)
+{
+	FileLoader loader(name);
+	loader.DivideIntoChunks(chunkSize, 1);
+
+	std::ifstream file(name, std::ios::binary);
+	std::string buffer;
+	Tokenizer<SeparatorPolicy> tokenizer;
+	std::vector<std::string> tokens;
+	while (const auto chunk = loader.ClaimChunk())
+	{
+		tokenizer.Tokenize(loader.LoadChunk(file, chunk.value(), buffer, SeparatorPolicy::BYTE_CLASSES), [&tokens](const Token& token) {
+			tokens.emplace_back(token.m_word);
+		});
+	}
+
+	return tokens;
+}
+
+/*
+	Csv file with empty first field in about half of records,
+	n-grams skip those records and may cross any chunk boundary
+*/
+void TestCsvQuoting()
+{
+	const std::string records = "1,\"Smith, John\"\n2,\"a \"\"b\"\"\"\n3,pl\"ain\n4,\"x\"y,z\n\"q,1\",k\r\n5,\"open\n6,\"\",e";
+	const std::vector<std::string> expected = { "Smith, John", "a \"\"b\"\"", "pl\"ain", "x", "k", "open" };
+
+	Tokenizer<CsvField> tokenizer(1);
+	std::vector<std::string> tokens;
+	bool hashesMatch = true;
+	tokenizer.Tokenize(records, [&tokens, &hashesMatch](const Token& token) {
+		tokens.emplace_back(token.m_word);
+		hashesMatch = hashesMatch && token.m_hash == WyHashPolicy::Hash(token.m_word);
+	});
+
+	Check(tokens == expected, "csv quoted values keep delimiters and skip their quotes");
+	Check(hashesMatch, "csv quoted values hash like their tokens");
+}
+
+void TestCsvNGrams(const std::unordered_map<ArgumentType, std::string>& args)
+{
+	const std::string name = "csv_ngram_test.csv";
+	{
+		std::ofstream file(name, std::ios::binary);
+		for (std::size_t record = 0; record < 100000; ++record)
+		{
+			if (rand() % 2 == 0)file << (char)('a' + rand() % 16) << (char)('a' + rand() % 16) << (char)('a' + rand() % 16);
+			file << "," << rand() % 100 << "\n";
+		}
+	}
+
+	// Single chunk holds the whole file
+	const std::vector<std::string> tokens = LoadChunks<CsvField>(name, 1 << 30);
+	for (const std::size_t n : { 2, 3 })
+	{
+		std::unordered_set<std::string> ngrams;
+		for (std::size_t i = 0; i + n <= tokens.size(); ++i)
+		{
+			std::string ngram = tokens[i];
+			for (std::size_t j = 1; j < n; ++j)
+			{
+				ngram += ' ' + tokens[i + j];
+			}
+			ngrams.insert(ngram);
+		}
+
+		for (const auto& [chunkSize, threads] : { std::pair{ "1", "1" }, std::pair{ "1", "4" }, std::pair{ "4", "3" }, std::pair{ "64", "2" } })
+		{
+			Pipeline task;
+			const Arguments csvArgs = WithArguments(args, { { ArgumentType::FILE_NAME, name }, { ArgumentType::SEPARATORS, "csv" },
+				{ ArgumentType::NGRAM, std::to_string(n) }, { ArgumentType::CHUNK_SIZE, chunkSize }, { ArgumentType::THREADS, threads } });
+			if (RunPipeline("Csv " + std::to_string(n) + "-grams, " + chunkSize + " KB chunks, " + threads + " threads", csvArgs, task))
+			{
+				Check(task.GetNumberOfDistinctWords() == ngrams.size(), "distinct csv n-grams equal to std::unordered_set");
+			}
+		}
+	}
+	std::remove(name.c_str());
+}
+
+void TestLoadChunk()
+{
+	const std::string name = "load_chunk_test.txt";
+	{
+		std::ofstream file(name, std::ios::binary);
+		file << "  alpha beta\t\tgamma\n\ndelta,epsilon zeta\r\neta,theta\n,iota\nkappa";
+	}
+
+	const std::vector<std::string> words = { "alpha", "beta", "gamma", "delta,epsilon", "zeta", "eta,theta", ",iota", "kappa" };
+	// Single chunk holds the whole file
+	const std::vector<std::string> firstColumn = LoadChunks<CsvField>(name, 1024);
+
+	bool whitespaceAligned = true, csvAligned = !firstColumn.empty();
+	for (std::size_t chunkSize = 1; chunkSize <= 80; ++chunkSize)
+	{
+		whitespaceAligned = whitespaceAligned && LoadChunks<WhitespaceSeparators>(name, chunkSize) == words;
+		csvAligned = csvAligned && LoadChunks<CsvField>(name, chunkSize) == firstColumn;
+	}
+	std::remove(name.c_str());
+
+	Check(whitespaceAligned, "LoadChunk aligns whitespace chunks of every size");
+	Check(csvAligned, "LoadChunk aligns csv records of every size");
+}
+
+template<class HashPolicy>
+void TestHashPolicy(const std::string& policyName, const std::vector<std::string>& words)
+{
+	constexpr std::size_t buckets = 50;
+	constexpr std::size_t slots = 64;
+	constexpr std::size_t repetitions = 10;
+
+	std::uint64_t checksum = 0;
+	auto start = std::chrono::system_clock::now();
+	for (std::size_t i = 0; i < repetitions; ++i)
+	{
+		for (const auto& word : words)
+		{
+			checksum += HashPolicy::Hash(word);
+		}
+	}
+	auto end = std::chrono::system_clock::now();
+	const double seconds = std::chrono::duration<double>(end - start).count();
+
+	// Distinct words only, duplicates would skew the distribution
+	std::unordered_set<std::string> distinct(words.begin(), words.end());
+	std::vector<std::size_t> bucketFill(buckets, 0);
+	std::vector<std::size_t> slotFill(slots, 0);
+	std::size_t wordsInFirstBucket = 0;
+	for (const auto& word : distinct)
+	{
+		const std::uint64_t hash = HashPolicy::Hash(word);
+		const std::size_t bucket = HashPolicy::Bucket(hash, buckets);
+		bucketFill[bucket]++;
+
+		// Slot distribution inside a single bucket shows correlation between bucket and slot bits
+		if (bucket == 0)
+		{
+			slotFill[HashPolicy::Slot(hash) % slots]++;
+			wordsInFirstBucket++;
+		}
+	}
+
+	auto chiSquare = [](const std::vector<std::size_t>& fill, const std::size_t total)
+	{
+		const double expected = (double)total / (double)fill.size();
+		double value = 0.0;
+		for (const std::size_t count : fill)
+		{
+			value += ((double)count - expected) * ((double)count - expected) / expected;
+		}
+		return value;
+	};
+
+	std::cout << policyName << "\n";
+	std::cout << "\tThroughput:\t" << (double)(words.size() * repetitions) / seconds / 1e6 << " Mhash/s (checksum " << checksum % 1000 << ")\n";
+	std::cout << "\tBucket chi^2:\t" << chiSquare(bucketFill, distinct.size()) << " (" << buckets - 1 << " degrees of freedom)\n";
+	std::cout << "\tSlot chi^2:\t" << chiSquare(slotFill, wordsInFirstBucket) << " (" << slots - 1 << " degrees of freedom)\n";
+}
+
+void TestHashPolicies(const std::string& name)
+{
+	std::ifstream file(name);
+	std::vector<std::string> words;
+	std::string word;
+	while (file >> word)
+	{
+		words.push_back(word);
+	}
+
+	// StreamingHasher has to match one-shot hash of the same bytes
+	std::size_t mismatches = 0;
+	StreamingHasher hasher;
+	for (const auto& w : words)
+	{
+		hasher.Reset();
+		for (const char character : w)hasher.Update((unsigned char)character);
+		if (hasher.Digest() != WyHashPolicy::Hash(w))mismatches++;
+	}
+	// Insert(Token) and Insert(std::string_view) would disagree otherwise
+	Check(mismatches == 0, "StreamingHasher equals WyHashPolicy::Hash of every word");
+
+	TestHashPolicy<WyHashPolicy>("WyHashPolicy", words);
+	TestHashPolicy<StdHashPolicy>("StdHashPolicy", words);
+}
+
+void TestAllocations(const std::string& name)
+{
+	std::ifstream file(name, std::ios::binary);
+	std::stringstream content;
+	content << file.rdbuf();
+	const std::string buffer = content.str();
+
+	if (!AllocationCountingEnabled())
+	{
+		std::cout << "\tSKIPPED: allocation checks, build with COUNT_ALLOCATIONS defined (Debug configuration) to count allocations\n";
+		return;
+	}
+
+	Tokenizer tokenizer;
+	std::uint64_t checksum = 0;
+
+	StartCountingAllocations();
+	const std::size_t words = tokenizer.Tokenize(buffer, [&checksum](const Token& token) {
+		checksum ^= token.m_hash;
+	});
+	const std::size_t tokenizerAllocations = StopCountingAllocations();
+
+	ConcurentSet<std::string_view> concurentSet(50);
+	StartCountingAllocations();
+	tokenizer.Tokenize(buffer, [&concurentSet](const Token& token) {
+		concurentSet.Insert(token);
+	});
+	const std::size_t insertAllocations = StopCountingAllocations();
+	const std::size_t distinct = concurentSet.GetSize();
+
+	std::cout << "Words:\t\t\t" << words << " (checksum " << checksum % 1000 << ")\n";
+	std::cout << "Tokenizer:\t\t" << (double)tokenizerAllocations / (double)words << " allocations per word\n";
+	std::cout << "Tokenizer + set:\t" << (double)insertAllocations / (double)words << " allocations per word, "
+		<< (double)insertAllocations / (double)distinct << " per distinct word\n";
+
+	Check(tokenizerAllocations == 0, "tokenizer does not allocate");
+	// Only new set nodes (and rehashing) may allocate
+	Check(insertAllocations <= 2 * distinct, "insert path allocates at most twice per distinct word");
+}
+
+std::size_t GetUniqueWordsTrie(const std::string& name, std::size_t& memoryUsage)
 {
 	TrieSet<char> trie('a', 26);
 	std::ifstream file(name);
@@ -65,9 +649,66 @@ std::size_t GetUniqueWordsTrie(const std::string& name)
 		trie.Insert(word.data(), word.length());
 	}
 
+	memoryUsage = trie.GetMemoryUsage();
 	return trie.GetSize();
 }
 
+/*
+	N-grams joined by a single space, the way they are exported
+*/
+static std::unordered_set<std::string> GetUniqueNGrams(const std::string& name, const std::size_t& n)
+{
+	std::unordered_set<std::string> set;
+	std::ifstream file(name);
+
+	std::deque<std::string> window;
+	std::string word;
+	while (file >> word)
+	{
+		window.push_back(word);
+		if (window.size() > n)window.pop_front();
+		if (window.size() < n)continue;
+
+		std::string ngram = window[0];
+		for (std::size_t i = 1; i < n; ++i)
+		{
+			ngram += ' ' + window[i];
+		}
+		set.insert(ngram);
+	}
+
+	return set;
+}
+
+std::size_t GetUniqueNGramsSTD(const std::string& name, const std::size_t& n)
+{
+	return GetUniqueNGrams(name, n).size();
+}
+
+std::vector<std::string> GetSortedUniqueNGrams(const std::string& name, const std::size_t& n)
+{
+	const std::unordered_set<std::string> set = GetUniqueNGrams(name, n);
+	std::vector<std::string> ngrams(set.begin(), set.end());
+	std::sort(ngrams.begin(), ngrams.end());
+	return ngrams;
+}
+
+std::vector<std::string> GetSortedUniqueWords(const std::string& name)
+{
+	std::unordered_set<std::string> set;
+	std::ifstream file(name);
+
+	std::string word;
+	while (file >> word)
+	{
+		set.insert(word);
+	}
+
+	std::vector<std::string> words(set.begin(), set.end());
+	std::sort(words.begin(), words.end());
+	return words;
+}
+
 std::size_t GetUniqueWordsSTD(const std::string& name)
 {
 	std::unordered_set<std::string> set;
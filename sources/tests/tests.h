@@ -2,12 +2,27 @@
 #define TESTS_H
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "../argument-parser/argument-parser.h"
 
-void Test(std::unordered_map<ArgumentType, std::string> args);
-std::size_t GetUniqueWordsTrie(const std::string& name);
+/*
+	Runs checks and benchmarks, returns false when any check failed
+*/
+bool Test(std::unordered_map<ArgumentType, std::string> args);
+void TestHashPolicies(const std::string& name);
+void TestAllocations(const std::string& name);
+void TestDeltaEncoding();
+void TestRadixSort();
+void TestLoadChunk();
+void TestCsvQuoting();
+void TestCsvNGrams(const std::unordered_map<ArgumentType, std::string>& args);
+void TestShardFiles();
+std::size_t GetUniqueWordsTrie(const std::string& name, std::size_t& memoryUsage);
 std::size_t GetUniqueWordsSTD(const std::string& name);
+std::size_t GetUniqueNGramsSTD(const std::string& name, const std::size_t& n);
+std::vector<std::string> GetSortedUniqueWords(const std::string& name);
+std::vector<std::string> GetSortedUniqueNGrams(const std::string& name, const std::size_t& n);
 
 void GenerateTestFile(std::size_t bytes, const std::string& name);
 
@@ -1,28 +1,115 @@
 #include <fstream>
 
 #include "thread-scheduler.h"
+#include "../duplicate-filter/duplicate-filter.h"
 
-bool ThreadFunction(ConcurentSet<std::string>& concurentSet, const std::pair<std::size_t, std::size_t>& dataBlock, const std::filesystem::path& filePath)
+template<class SeparatorPolicy, class Set>
+bool ThreadFunction(Set& set, FileLoader& loader, const WorkerSettings settings, WorkerStatistics& statistics, WorkerProgress* progress)
 {
-	std::ifstream file(filePath);
+	std::ifstream file(loader.GetFilePath(), std::ios::binary);
 	if (!file)return false;
 
-	file.seekg(dataBlock.first);
-	std::string input;
-	while (!file.eof() && (std::size_t)file.tellg() < dataBlock.second)
+	// Buffer is reused between chunks, it only grows up to chunk size
+	std::string buffer;
+	Tokenizer<SeparatorPolicy> tokenizer(settings.m_field);
+	DuplicateFilter filter(settings.m_filterBytes);
+
+	NGramHasher ngrams(settings.m_ngram);
+	// Read-ahead counts tokens, csv records with empty selected field add none
+	auto countTokens = [&tokenizer](std::string_view record) {
+		return tokenizer.Tokenize(record, [](const Token&) {});
+	};
+
+	auto insert = [&set, &filter, &settings](Token token) {
+		if (settings.m_partitions > 1 && WyHashPolicy::Partition(token.m_hash, settings.m_partitions) != settings.m_partition)return;
+		// Filter indexes sets by the low bits, tag them only on the way into the set
+		if (filter.Enabled() && filter.CheckAndInsert(token.m_hash))return;
+		if (settings.m_membershipTag != 0)token.m_hash = TagMembership(token.m_hash, settings.m_membershipTag);
+		set.Insert(token);
+	};
+
+	// Stop is checked between chunks, partial result contains only whole chunks
+	while (!StopRequested())
 	{
-		file >> input;
-		concurentSet.Insert(input);
+		const auto chunk = loader.ClaimChunk();
+		if (!chunk.has_value())break;
+
+		// N-grams starting in the last tokens of chunk need following m_ngram - 1 tokens
+		const std::string_view words = loader.LoadChunk(file, chunk.value(), buffer, SeparatorPolicy::BYTE_CLASSES, settings.m_ngram - 1, countTokens);
+		if (file.bad())
+		{
+			// LoadChunk clears the stream state, the next chunk is tried again
+			statistics.m_unreadBytes += chunk->second - chunk->first;
+			continue;
+		}
+		std::size_t tokens = 0;
+		if (settings.m_ngram > 1)
+		{
+			ngrams.Reset();
+			tokens = tokenizer.Tokenize(words, [&ngrams, &insert, &settings](const Token& token) {
+				if (!ngrams.Push(token))return;
+				insert(settings.m_keepWords ? ngrams.GetToken() : Token{ {}, ngrams.GetHash() });
+			});
+		}
+		else
+		{
+			tokens = tokenizer.Tokenize(words, insert);
+		}
+		statistics.m_words += tokens;
+
+		if (progress != nullptr)
+		{
+			progress->m_bytes.fetch_add(chunk->second - chunk->first, std::memory_order_relaxed);
+			progress->m_words.fetch_add(tokens, std::memory_order_relaxed);
+		}
 	}
 
+	statistics.m_filterLookups = filter.GetLookups();
+	statistics.m_filterHits = filter.GetHits();
+
 	return true;
 }
 
-void ThreadScheduler::Start(ConcurentSet<std::string> & concurentSet, const FileLoader& loader)
+void ThreadScheduler::Start(ConcurentSet<std::string_view> & concurentSet, FileLoader& loader, const WorkerSettings& settings)
+{
+	StartWithSeparators(concurentSet, loader, settings);
+}
+
+void ThreadScheduler::Start(MinHashSketch& sketch, FileLoader& loader, const WorkerSettings& settings)
+{
+	StartWithSeparators(sketch, loader, settings);
+}
+
+template<class Set>
+void ThreadScheduler::StartWithSeparators(Set& set, FileLoader& loader, const WorkerSettings& settings)
+{
+	// Sized up front, workers keep references to their own entry
+	m_statistics.assign(settings.m_threads, WorkerStatistics());
+
+	switch (settings.m_separatorMode)
+	{
+	case SeparatorMode::WHITESPACE:
+		StartWorkers<WhitespaceSeparators>(set, loader, settings);
+		break;
+	case SeparatorMode::PUNCTUATION:
+		StartWorkers<PunctuationSeparators>(set, loader, settings);
+		break;
+	case SeparatorMode::CSV:
+		StartWorkers<CsvField>(set, loader, settings);
+		break;
+	case SeparatorMode::TSV:
+		StartWorkers<TsvField>(set, loader, settings);
+		break;
+	}
+}
+
+template<class SeparatorPolicy, class Set>
+void ThreadScheduler::StartWorkers(Set& set, FileLoader& loader, const WorkerSettings& settings)
 {
-	for (const auto& block : loader.GetBlocks())
+	for (std::size_t i = 0; i < settings.m_threads; ++i)
 	{
-		std::thread th{ ThreadFunction, std::ref(concurentSet), block, loader.GetFilePath()};
+		WorkerProgress* progress = settings.m_progress != nullptr ? &settings.m_progress->GetWorker(i) : nullptr;
+		std::thread th{ ThreadFunction<SeparatorPolicy, Set>, std::ref(set), std::ref(loader), settings, std::ref(m_statistics[i]), progress };
 		m_threads.push_back(std::move(th));
 	}
 }
@@ -41,3 +128,17 @@ void ThreadScheduler::Synchronize()
 		}
 	}
 }
+
+WorkerStatistics ThreadScheduler::GetStatistics() const
+{
+	WorkerStatistics sum;
+	for (const auto& statistics : m_statistics)
+	{
+		sum.m_words += statistics.m_words;
+		sum.m_filterLookups += statistics.m_filterLookups;
+		sum.m_filterHits += statistics.m_filterHits;
+		sum.m_unreadBytes += statistics.m_unreadBytes;
+	}
+
+	return sum;
+}
@@ -3,19 +3,74 @@
 
 #include <thread>
 #include <list>
+#include <vector>
 #include <filesystem>
 
 #include "../concurent-set/concurent-set.h"
 #include "../file-loader/file-loader.h"
+#include "../min-hash/min-hash.h"
+#include "../progress/progress.h"
 
 
+struct WorkerStatistics
+{
+	std::size_t m_words = 0;
+	std::size_t m_filterLookups = 0;
+	std::size_t m_filterHits = 0;
+	// Bytes of claimed chunks which could not be read, they are missing from the result
+	std::size_t m_unreadBytes = 0;
+};
+
+struct WorkerSettings
+{
+	std::size_t m_threads = 1;
+	// Size of per worker DuplicateFilter, 0 disables it
+	std::size_t m_filterBytes = 0;
+	SeparatorMode m_separatorMode = SeparatorMode::WHITESPACE;
+	// Zero based field index for SeparatorMode::CSV and SeparatorMode::TSV
+	std::size_t m_field = 0;
+	// Only hashes of WyHashPolicy::Partition == m_partition are inserted
+	std::size_t m_partition = 0;
+	std::size_t m_partitions = 1;
+	// Count distinct sequences of m_ngram consecutive tokens, 1 counts single words
+	std::size_t m_ngram = 1;
+	// N-grams are joined into text only when the set keeps words for export
+	bool m_keepWords = false;
+	// Membership tag (FIRST_INPUT, SECOND_INPUT) stored in low bits of every hash, 0 keeps hashes intact
+	std::uint64_t m_membershipTag = 0;
+	// Worker i publishes to m_progress->GetWorker(i) after every chunk, nullptr disables publishing
+	ProgressCounters* m_progress = nullptr;
+};
+
 class ThreadScheduler
 {
 public:
-	void Start(ConcurentSet<std::string>& concurentSet, const FileLoader & loader);
+	/*
+		Starts settings.m_threads workers, each claims chunks from loader until none are left
+		or stop is requested (see RequestStop).
+		Tokenizer is specialized for settings.m_separatorMode once, here.
+	*/
+	void Start(ConcurentSet<std::string_view>& concurentSet, FileLoader & loader, const WorkerSettings& settings);
+
+	/*
+		Same as above, fills MinHashSketch instead of exact set
+	*/
+	void Start(MinHashSketch& sketch, FileLoader& loader, const WorkerSettings& settings);
 	void Synchronize();
+
+	/*
+		Sum of all workers statistics, valid after Synchronize
+	*/
+	WorkerStatistics GetStatistics() const;
 private:
+	template<class Set>
+	void StartWithSeparators(Set& set, FileLoader& loader, const WorkerSettings& settings);
+
+	template<class SeparatorPolicy, class Set>
+	void StartWorkers(Set& set, FileLoader& loader, const WorkerSettings& settings);
+
 	std::list<std::thread> m_threads;
+	std::vector<WorkerStatistics> m_statistics;
 };
 
 #endif
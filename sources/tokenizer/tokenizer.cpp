@@ -0,0 +1 @@
+#include "tokenizer.h"
\ No newline at end of file
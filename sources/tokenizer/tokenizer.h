@@ -0,0 +1,332 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <array>
+#include <vector>
+
+#include "../hash/hash.h"
+
+/*
+	Word found in an input buffer. Does not own its characters,
+	m_hash is WyHashPolicy::Hash of m_word.
+*/
+struct Token
+{
+	std::string_view m_word;
+	std::uint64_t m_hash;
+};
+
+/*
+	Class of every byte value, generated at compile time by separator policies
+	- WORD_BYTE       - part of a token
+	- SEPARATOR       - ends token
+	- FIELD_DELIMITER - ends token and moves to the next field
+	- RECORD_END      - ends token and record, chunks are aligned to it
+	- QUOTE           - opens quoted field when it starts a field, otherwise WORD_BYTE
+*/
+enum ByteClass : unsigned char
+{
+	WORD_BYTE, SEPARATOR, FIELD_DELIMITER, RECORD_END, QUOTE
+};
+
+using ByteClassTable = std::array<unsigned char, 256>;
+
+constexpr ByteClassTable MakeByteClassTable(std::string_view separators, std::string_view delimiters, std::string_view recordEnds,
+	std::string_view quotes = "")
+{
+	ByteClassTable table{};
+	for (const char character : quotes)table[(unsigned char)character] = QUOTE;
+	for (const char character : separators)table[(unsigned char)character] = SEPARATOR;
+	for (const char character : delimiters)table[(unsigned char)character] = FIELD_DELIMITER;
+	for (const char character : recordEnds)table[(unsigned char)character] = RECORD_END;
+	return table;
+}
+
+/*
+	Separator policies
+	Every policy provides:
+	- FIELD_MODE   - when true only the selected field of every record is a token
+	- BYTE_CLASSES - ByteClassTable
+*/
+
+/*
+	Same bytes as std::isspace in "C" locale
+*/
+struct WhitespaceSeparators
+{
+	static constexpr bool FIELD_MODE = false;
+	static constexpr ByteClassTable BYTE_CLASSES = MakeByteClassTable("", "", " \t\n\v\f\r");
+};
+
+template<char... Separators>
+struct CustomSeparators
+{
+	static constexpr bool FIELD_MODE = false;
+	static constexpr char SEPARATORS[] = { Separators... };
+	static constexpr ByteClassTable BYTE_CLASSES = MakeByteClassTable("", "", std::string_view(SEPARATORS, sizeof...(Separators)));
+};
+
+using PunctuationSeparators = CustomSeparators<' ', '\t', '\n', '\v', '\f', '\r',
+	',', '.', ';', ':', '!', '?', '"', '(', ')', '[', ']', '{', '}'>;
+
+/*
+	Records are lines, fields are split by Delimiter, '\r' is trimmed.
+	Field starting with Quote (RFC 4180) ends at the next single Quote, delimiters inside
+	belong to the value. Token is the value without enclosing quotes, escaped quotes stay
+	doubled, so distinct values still map to distinct tokens. Quoted values cannot span
+	lines, chunks are aligned to line ends. Quote 0 disables quoting.
+*/
+template<char Delimiter, char Quote = 0>
+struct DelimitedField
+{
+	static constexpr bool FIELD_MODE = true;
+	static constexpr char DELIMITERS[] = { Delimiter };
+	static constexpr char QUOTES[] = { Quote };
+	static constexpr ByteClassTable BYTE_CLASSES = MakeByteClassTable("\r", std::string_view(DELIMITERS, 1), "\n",
+		std::string_view(QUOTES, Quote != 0 ? 1 : 0));
+};
+
+using CsvField = DelimitedField<',', '"'>;
+using TsvField = DelimitedField<'\t'>;
+
+/*
+	Runtime selection of separator policy, see ThreadScheduler
+*/
+enum class SeparatorMode
+{
+	WHITESPACE, PUNCTUATION, CSV, TSV
+};
+
+/*
+	Combines hashes of the last n tokens into n-gram fingerprint with polynomial
+	rolling hash: h[0] * P^(n-1) + ... + h[n-1] (mod 2^64), mixed once more
+	so bucket and slot bits stay independent. Every token costs one multiply-add.
+*/
+class NGramHasher
+{
+public:
+	explicit NGramHasher(const std::size_t& n);
+
+	/*
+		Forgets all tokens, next n-gram starts from the next pushed token
+	*/
+	void Reset();
+
+	/*
+		Adds token to the window, returns true when window holds n tokens
+	*/
+	bool Push(const Token& token);
+
+	/*
+		Fingerprint of the current window, same as GetToken().m_hash without joining tokens
+	*/
+	std::uint64_t GetHash() const;
+
+	/*
+		N-gram of the current window, m_word holds its tokens joined by a single space,
+		so n-grams differing only in separators (or other csv fields) look the same.
+		m_word is valid until the next GetToken call.
+	*/
+	Token GetToken();
+
+private:
+	static constexpr std::uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ull;
+
+	std::vector<Token> m_window;
+	std::string m_joined;
+	std::size_t m_next;
+	std::size_t m_filled;
+	std::uint64_t m_sum;
+	std::uint64_t m_oldestPower;
+};
+
+inline NGramHasher::NGramHasher(const std::size_t& n) : m_window(n == 0 ? 1 : n)
+{
+	m_oldestPower = 1;
+	for (std::size_t i = 1; i < m_window.size(); ++i)
+	{
+		m_oldestPower *= MULTIPLIER;
+	}
+
+	Reset();
+}
+
+inline void NGramHasher::Reset()
+{
+	m_next = 0;
+	m_filled = 0;
+	m_sum = 0;
+}
+
+inline bool NGramHasher::Push(const Token& token)
+{
+	// With full window m_next points at the oldest token
+	if (m_filled == m_window.size())
+	{
+		m_sum -= m_window[m_next].m_hash * m_oldestPower;
+	}
+	else
+	{
+		m_filled++;
+	}
+
+	m_sum = m_sum * MULTIPLIER + token.m_hash;
+	m_window[m_next] = token;
+	m_next = (m_next + 1) % m_window.size();
+
+	return m_filled == m_window.size();
+}
+
+inline std::uint64_t NGramHasher::GetHash() const
+{
+	return HashMix(m_sum ^ HASH_SECRET[2], m_window.size() ^ HASH_SECRET[0]);
+}
+
+inline Token NGramHasher::GetToken()
+{
+	// Buffer is reused, it only grows up to the longest n-gram
+	m_joined.clear();
+	for (std::size_t i = 0; i < m_window.size(); ++i)
+	{
+		if (i != 0)m_joined.push_back(' ');
+		m_joined.append(m_window[(m_next + i) % m_window.size()].m_word);
+	}
+
+	return Token{ m_joined, GetHash() };
+}
+
+/*
+	Hashes value of quoted field opened at quote, doubled quotes are kept as written.
+	Returns index of the last byte which belongs to the field: closing quote,
+	or last byte before delimiter when closing quote is followed by stray bytes.
+	Unclosed value ends before record end.
+*/
+template<class SeparatorPolicy>
+inline std::size_t ScanQuotedValue(std::string_view buffer, std::size_t quote, StreamingHasher& hasher)
+{
+	auto byteClass = [&buffer](const std::size_t i) {
+		return SeparatorPolicy::BYTE_CLASSES[(unsigned char)buffer[i]];
+	};
+
+	std::size_t i = quote + 1;
+	for (; i < buffer.size() && byteClass(i) != RECORD_END; ++i)
+	{
+		if (byteClass(i) == QUOTE)
+		{
+			if (i + 1 < buffer.size() && byteClass(i + 1) == QUOTE)
+			{
+				hasher.Update((unsigned char)buffer[i]);
+				hasher.Update((unsigned char)buffer[++i]);
+				continue;
+			}
+			break;
+		}
+		hasher.Update((unsigned char)buffer[i]);
+	}
+	if (i == buffer.size() || byteClass(i) == RECORD_END)return i - 1;
+
+	// Bytes between closing quote and delimiter are not part of any value
+	while (i + 1 < buffer.size() && (byteClass(i + 1) == WORD_BYTE || byteClass(i + 1) == QUOTE))
+	{
+		i++;
+	}
+	return i;
+}
+
+template<class SeparatorPolicy = WhitespaceSeparators>
+class Tokenizer
+{
+public:
+	/*
+		field - zero based index of extracted field, used only in FIELD_MODE
+	*/
+	explicit Tokenizer(const std::size_t& field = 0);
+
+	/*
+		Splits buffer and calls callback(const Token&) for every token.
+		Hash is calculated in the same pass, nothing is allocated.
+		Returns number of tokens found.
+	*/
+	template<class Callback>
+	std::size_t Tokenize(std::string_view buffer, Callback&& callback) const;
+
+private:
+	std::size_t m_field;
+};
+
+template<class SeparatorPolicy>
+inline Tokenizer<SeparatorPolicy>::Tokenizer(const std::size_t& field)
+{
+	m_field = field;
+}
+
+template<class SeparatorPolicy>
+template<class Callback>
+inline std::size_t Tokenizer<SeparatorPolicy>::Tokenize(std::string_view buffer, Callback&& callback) const
+{
+	std::size_t tokens = 0;
+	std::size_t wordStart = 0;
+	std::size_t field = 0;
+	StreamingHasher hasher;
+
+	for (std::size_t i = 0; i < buffer.size(); ++i)
+	{
+		const unsigned char character = (unsigned char)buffer[i];
+		const unsigned char byteClass = SeparatorPolicy::BYTE_CLASSES[character];
+		if (byteClass == WORD_BYTE)
+		{
+			hasher.Update(character);
+			continue;
+		}
+
+		if constexpr (SeparatorPolicy::FIELD_MODE)
+		{
+			if (byteClass == QUOTE)
+			{
+				if (i != wordStart)
+				{
+					// Quote inside unquoted value is an ordinary byte
+					hasher.Update(character);
+					continue;
+				}
+
+				i = ScanQuotedValue<SeparatorPolicy>(buffer, i, hasher);
+				if (hasher.GetLength() != 0 && field == m_field)
+				{
+					callback(Token{ buffer.substr(wordStart + 1, hasher.GetLength()), hasher.Digest() });
+					tokens++;
+				}
+				hasher.Reset();
+				wordStart = i + 1;
+				continue;
+			}
+		}
+
+		if (hasher.GetLength() != 0 && (!SeparatorPolicy::FIELD_MODE || field == m_field))
+		{
+			callback(Token{ buffer.substr(wordStart, i - wordStart), hasher.Digest() });
+			tokens++;
+		}
+		hasher.Reset();
+		wordStart = i + 1;
+
+		if constexpr (SeparatorPolicy::FIELD_MODE)
+		{
+			if (byteClass == FIELD_DELIMITER)field++;
+			else if (byteClass == RECORD_END)field = 0;
+		}
+	}
+
+	if (hasher.GetLength() != 0 && (!SeparatorPolicy::FIELD_MODE || field == m_field))
+	{
+		callback(Token{ buffer.substr(wordStart), hasher.Digest() });
+		tokens++;
+	}
+
+	return tokens;
+}
+
+#endif
@@ -36,6 +36,11 @@ public:
 
 	std::size_t GetSize() const;
 
+	/*
+		Bytes used by trie nodes and their child tables
+	*/
+	std::size_t GetMemoryUsage() const;
+
 	//---
 	allocator_type GetAllocator() const noexcept;
 private:
@@ -60,6 +65,7 @@ private:
 	std::unique_ptr<Node> m_root;
 	std::size_t m_dictionarySize;
 	std::size_t m_size;
+	std::size_t m_nodes;
 
 	std::unordered_map<Key, std::size_t, Hash, KeyEqual, Allocator> m_dictionary;
 };
@@ -94,6 +100,7 @@ template<class Key, class Hash, class SequenceContainer, class KeyEqual, class A
 inline TrieSet<Key, Hash, SequenceContainer, KeyEqual, Allocator>::TrieSet()
 {
 	m_size = 0;
+	m_nodes = 0;
 }
 
 template<class Key, class Hash, class SequenceContainer, class KeyEqual, class Allocator>
@@ -108,6 +115,7 @@ inline TrieSet<Key, Hash, SequenceContainer, KeyEqual, Allocator>::TrieSet(const
 
 	m_size = 0;
 	m_root = std::make_unique<Node>(m_dictionarySize);
+	m_nodes = 1;
 }
 
 template<class Key, class Hash, class SequenceContainer, class KeyEqual, class Allocator>
@@ -130,6 +138,7 @@ inline TrieSet<Key, Hash, SequenceContainer, KeyEqual, Allocator>::TrieSet(const
 
 	m_size = 0;
 	m_root = std::make_unique<Node>(m_dictionarySize);
+	m_nodes = 1;
 }
 
 template<class Key, class Hash, class SequenceContainer, class KeyEqual, class Allocator>
@@ -189,6 +198,7 @@ inline TrieSet<Key, Hash, SequenceContainer, KeyEqual, Allocator>::Node * TrieSe
 
 	if (node->m_children[positionInDictionarySequence] == nullptr) {
 		node->m_children[positionInDictionarySequence] = std::make_unique<Node>(m_dictionarySize);
+		m_nodes++;
 	}
 
 	return node->m_children[positionInDictionarySequence].get();
@@ -220,6 +230,7 @@ inline void TrieSet<Key, Hash, SequenceContainer, KeyEqual, Allocator>::Clear()
 
 	m_dictionarySize = 0;
 	m_size = 0;
+	m_nodes = 0;
 }
 
 template<class Key, class Hash, class SequenceContainer, class KeyEqual, class Allocator>
@@ -228,6 +239,12 @@ inline std::size_t TrieSet<Key, Hash, SequenceContainer, KeyEqual, Allocator>::G
 	return m_size;
 }
 
+template<class Key, class Hash, class SequenceContainer, class KeyEqual, class Allocator>
+inline std::size_t TrieSet<Key, Hash, SequenceContainer, KeyEqual, Allocator>::GetMemoryUsage() const
+{
+	return sizeof(*this) + m_nodes * (sizeof(Node) + m_dictionarySize * sizeof(std::unique_ptr<Node>));
+}
+
 template<class Key, class Hash, class SequenceContainer, class KeyEqual, class Allocator>
 inline bool TrieSet<Key, Hash, SequenceContainer, KeyEqual, Allocator>::Contains(Node* node, const  SequenceContainer& sequence) const
 {
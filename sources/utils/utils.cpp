@@ -4,9 +4,27 @@ void printHelp()
 {
 	std::cout << "\n --- \n";
 	std::cout << "Distinct word analyzer\n";
-	std::cout << "Usage: [file] [-t] [-x]\n";
+	std::cout << "Usage: [file] [-t] [-c] [-f] [-s] [-k] [-n] [-p] [-r] [-o] [-e] [--max-memory] [--compare] [--sketch] [--progress] [-x]\n";
+	std::cout << "       merge [output] [shard...]\n";
 	std::cout << "Arguments\n";
 	std::cout << "\tfile - path to a file to process\n";
-	std::cout << "\t-t=50 - number of threads  \n";
+	std::cout << "\t-t=8 - number of threads (default: number of hardware threads)  \n";
+	std::cout << "\t-c=4096 - chunk size in KB claimed by a thread at once (default: automatic)  \n";
+	std::cout << "\t-f=32 - per thread duplicate filter size in KB, 0 disables it (default: 0)  \n";
+	std::cout << "\t-s=space - word separators: space, punct, csv or tsv (default: space)  \n";
+	std::cout << "\t-k=1 - for csv and tsv, one based number of the column to count (default: 1)  \n";
+	std::cout << "\t\tcsv values may be quoted (RFC 4180), quoted values cannot span lines and keep escaped quotes doubled  \n";
+	std::cout << "\t-n=2 - count distinct sequences of n consecutive words (default: 1)  \n";
+	std::cout << "\t-p=0/4 - count only hash partition 0 of 4 (default: all)  \n";
+	std::cout << "\t-r=0:1048576 - count only words starting in byte range [start; end) (default: whole file)  \n";
+	std::cout << "\t-o=out.shard - write distinct set to a shard file  \n";
+	std::cout << "\t-e=words.txt - export sorted distinct words, - or bare -e writes to standard output  \n";
+	std::cout << "\t--max-memory=512 - soft memory target of distinct set in MB, write buffers are compacted to fit it, compacted hashes (about 6 bytes each) and words kept for -e are not limited (default: none)  \n";
+	std::cout << "\t--compare=other.txt - count words of file, of other.txt, shared by both and only in one of them  \n";
+	std::cout << "\t--sketch=1024 - estimate counts and Jaccard similarity with MinHash sketch of given size in constant memory (default size: 1024)  \n";
+	std::cout << "\t--progress=5 - print throughput, ETA and memory every given number of seconds (default: 1 when given)  \n";
 	std::cout << "\t-x - perform test  \n";
+	std::cout << "\tmerge - merge shard files into output and print number of distinct words  \n";
+	std::cout << "SIGINT or SIGTERM stops counting after current chunks and prints partial result, a second one terminates  \n";
+	std::cout << "Partial results exit with 2, shards written or merged from them are flagged as partial  \n";
 }
\ No newline at end of file
@@ -0,0 +1 @@
+#include "varint.h"
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <cstdint>
+
+/*
+	LEB128 coding of unsigned 64-bit values: 7 bits per byte, least significant first,
+	high bit set on every byte but the last. Shared by in-memory runs and shard files.
+*/
+
+/*
+	Appends value to bytes, Bytes has to provide push_back of char or unsigned char
+*/
+template<class Bytes>
+inline void AppendVarint(Bytes& bytes, std::uint64_t value)
+{
+	using Byte = typename Bytes::value_type;
+	while (value >= 0x80)
+	{
+		bytes.push_back((Byte)(unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back((Byte)(unsigned char)value);
+}
+
+/*
+	Decodes value from bytes returned by readByte(unsigned char&) -> bool.
+	Returns false when readByte fails or encoding is longer than 64 bits.
+*/
+template<class ReadByte>
+inline bool ReadVarint(ReadByte&& readByte, std::uint64_t& value)
+{
+	value = 0;
+	unsigned char byte = 0;
+	unsigned int shift = 0;
+	do
+	{
+		if (shift > 63 || !readByte(byte))return false;
+		value |= (std::uint64_t)(byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	return true;
+}
+
+/*
+	Decodes value from trusted memory and advances position past it
+*/
+inline std::uint64_t ReadVarint(const unsigned char*& position)
+{
+	std::uint64_t value = 0;
+	ReadVarint([&position](unsigned char& byte) {
+		byte = *position++;
+		return true;
+	}, value);
+
+	return value;
+}
+
+#endif
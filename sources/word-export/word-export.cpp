@@ -0,0 +1,160 @@
+#include "word-export.h"
+#include <algorithm>
+#include <atomic>
+#include <queue>
+#include <thread>
+#include <array>
+
+static constexpr std::size_t INSERTION_THRESHOLD = 32;
+static constexpr std::size_t OUTPUT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+/*
+	0 marks end of word, byte values are shifted by 1
+*/
+static std::size_t RadixKey(const std::string_view& word, const std::size_t depth)
+{
+	return depth < word.size() ? (std::size_t)(unsigned char)word[depth] + 1 : 0;
+}
+
+static void RadixSort(std::string_view* begin, std::string_view* end, std::string_view* temporary, std::size_t depth)
+{
+	// Recurses only into smaller partitions and loops on the largest one,
+	// so long common prefixes do not grow the stack
+	while (end - begin >= 2)
+	{
+		const std::size_t size = (std::size_t)(end - begin);
+		if (size < INSERTION_THRESHOLD)
+		{
+			// All words share first depth bytes
+			std::sort(begin, end, [depth](const std::string_view& left, const std::string_view& right) {
+				return left.substr(depth) < right.substr(depth);
+			});
+			return;
+		}
+
+		std::array<std::size_t, 258> offsets{};
+		for (const std::string_view* word = begin; word != end; ++word)
+		{
+			offsets[RadixKey(*word, depth) + 1]++;
+		}
+		for (std::size_t key = 1; key < offsets.size(); ++key)
+		{
+			offsets[key] += offsets[key - 1];
+		}
+
+		std::array<std::size_t, 258> positions = offsets;
+		for (const std::string_view* word = begin; word != end; ++word)
+		{
+			temporary[positions[RadixKey(*word, depth)]++] = *word;
+		}
+		std::copy(temporary, temporary + size, begin);
+
+		// Key 0 holds words which ended, they are equal
+		std::size_t largest = 1;
+		for (std::size_t key = 1; key < 257; ++key)
+		{
+			if (offsets[key + 1] - offsets[key] > offsets[largest + 1] - offsets[largest])largest = key;
+		}
+		for (std::size_t key = 1; key < 257; ++key)
+		{
+			if (key == largest)continue;
+			RadixSort(begin + offsets[key], begin + offsets[key + 1], temporary + offsets[key], depth + 1);
+		}
+
+		end = begin + offsets[largest + 1];
+		begin += offsets[largest];
+		temporary += offsets[largest];
+		depth++;
+	}
+}
+
+void RadixSort(std::vector<std::string_view>& words)
+{
+	std::vector<std::string_view> temporary(words.size());
+	RadixSort(words.data(), words.data() + words.size(), temporary.data(), 0);
+}
+
+std::size_t ExportSortedWords(const ConcurentSet<std::string_view>& set, std::ostream& output, const std::size_t& threads,
+	const std::uint64_t ignoredBits)
+{
+	const std::size_t buckets = set.GetNumberOfBuckets();
+
+	// Every bucket is a shard sorted on its own, workers claim them like file chunks
+	std::vector<std::vector<std::string_view>> shards(buckets);
+	std::atomic<std::size_t> nextShard = 0;
+	auto sortShards = [&]() {
+		for (std::size_t shard = nextShard++; shard < buckets; shard = nextShard++)
+		{
+			// Compacted buckets may keep a word twice, dedup on the hash like the count does
+			std::vector<std::pair<std::uint64_t, std::string_view>> kept;
+			set.ForEachWord(shard, [&kept, ignoredBits](const std::uint64_t hash, const std::string_view word) {
+				kept.emplace_back(hash & ~ignoredBits, word);
+			});
+			std::sort(kept.begin(), kept.end(), [](const auto& left, const auto& right) {
+				return left.first < right.first;
+			});
+			kept.erase(std::unique(kept.begin(), kept.end(), [](const auto& left, const auto& right) {
+				return left.first == right.first;
+			}), kept.end());
+
+			auto& words = shards[shard];
+			words.reserve(kept.size());
+			for (const auto& [hash, word] : kept)
+			{
+				words.push_back(word);
+			}
+			RadixSort(words);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (std::size_t i = 1; i < std::max<std::size_t>(threads, 1); ++i)
+	{
+		workers.emplace_back(sortShards);
+	}
+	sortShards();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	// Min-heap of (word, shard) for k-way merge
+	using HeapEntry = std::pair<std::string_view, std::size_t>;
+	std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+	std::vector<std::size_t> shardPositions(buckets, 0);
+	for (std::size_t shard = 0; shard < buckets; ++shard)
+	{
+		if (!shards[shard].empty())heap.emplace(shards[shard][0], shard);
+	}
+
+	std::vector<char> buffer;
+	buffer.reserve(OUTPUT_BUFFER_SIZE);
+	std::size_t written = 0;
+
+	while (!heap.empty())
+	{
+		const auto [word, shard] = heap.top();
+		heap.pop();
+
+		if (++shardPositions[shard] < shards[shard].size())
+		{
+			heap.emplace(shards[shard][shardPositions[shard]], shard);
+		}
+
+		// Buckets are chosen by high bits, tags live in low bits, so no word repeats across shards
+		written++;
+
+		if (buffer.size() + word.size() + 1 > OUTPUT_BUFFER_SIZE)
+		{
+			output.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+		buffer.insert(buffer.end(), word.begin(), word.end());
+		buffer.push_back('\n');
+	}
+
+	output.write(buffer.data(), buffer.size());
+	output.flush();
+
+	return written;
+}
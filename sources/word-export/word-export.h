@@ -0,0 +1,29 @@
+#ifndef WORD_EXPORT_H
+#define WORD_EXPORT_H
+
+#include <vector>
+#include <string_view>
+#include <ostream>
+
+#include "../concurent-set/concurent-set.h"
+
+/*
+	MSD radix sort on bytes of words, falls back to std::sort for small ranges.
+	Order is the same as std::string_view comparison (bytes as unsigned char).
+*/
+void RadixSort(std::vector<std::string_view>& words);
+
+/*
+	Writes every distinct word kept by set (see ConcurentSet::SetKeepWords) to output,
+	one per line, in sorted order:
+	- buckets are sorted in parallel by threads workers with RadixSort,
+	- sorted buckets are k-way merged and written through large buffer.
+	Words are deduplicated on their hash, so the export matches ConcurentSet::GetSize.
+	ignoredBits are masked out before deduplicating, MEMBERSHIP_MASK exports union
+	of a set tagged with TagMembership.
+	Returns number of written words.
+*/
+std::size_t ExportSortedWords(const ConcurentSet<std::string_view>& set, std::ostream& output, const std::size_t& threads,
+	const std::uint64_t ignoredBits = 0);
+
+#endif